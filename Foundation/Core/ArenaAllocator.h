@@ -0,0 +1,245 @@
+#pragma once
+#include "BasicType.h"
+#include "CompressedPair.h"
+#include "ScopeGuard.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace X
+{
+	// Block source of ArenaAllocator, stateless so it takes no space.
+	struct GlobalBlockAllocator
+	{
+		void* Allocate(std::size_t size)
+		{
+			return ::operator new(size);
+		}
+
+		void Free(void* memory, std::size_t size) noexcept
+		{
+			::operator delete(memory, size);
+		}
+	};
+
+	/*
+	*	Bump pointer allocator over a chain of blocks, individual allocations are never freed.
+	*	GetMarker() and Rewind() release everything allocated after the marker at once, blocks are kept and reused,
+	*	so a warmed up arena serves each frame or request without touching Upstream. Blocks go back to Upstream in the destructor only.
+	*	Upstream provides Allocate(size) and Free(memory, size).
+	*/
+	template <class Upstream = GlobalBlockAllocator>
+	class BasicArenaAllocator
+	{
+		struct Block
+		{
+			Block* next;
+			std::size_t size;
+
+			unsigned char* Begin() noexcept
+			{
+				return reinterpret_cast<unsigned char*>(this) + HeaderSize;
+			}
+
+			unsigned char* End() noexcept
+			{
+				return reinterpret_cast<unsigned char*>(this) + size;
+			}
+		};
+
+		static constexpr std::size_t HeaderSize = (sizeof(Block) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+	public:
+		static constexpr std::size_t DefaultBlockSize = 64 * 1024;
+
+		struct Marker
+		{
+			Block* block;
+			unsigned char* position;
+		};
+
+	public:
+		explicit BasicArenaAllocator(std::size_t blockSize = DefaultBlockSize, Upstream upstream = Upstream()) noexcept : blocks(std::move(upstream), nullptr), blockSize(blockSize)
+		{
+			assert(blockSize > HeaderSize);
+		}
+
+		~BasicArenaAllocator() noexcept
+		{
+			Block* block = blocks.E1();
+			while (block)
+			{
+				Block* next = block->next;
+				blocks.E0().Free(block, block->size);
+				block = next;
+			}
+		}
+
+		BasicArenaAllocator(BasicArenaAllocator const&) = delete;
+		BasicArenaAllocator& operator=(BasicArenaAllocator const&) = delete;
+
+		// alignment is a power of 2.
+		void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+		{
+			assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+			unsigned char* p = Align(position, alignment);
+			if (!current || p > end || static_cast<std::size_t>(end - p) < size)
+			{
+				p = Grow(size, alignment);
+			}
+			position = p + size;
+			return p;
+		}
+
+		// Destructors are not run, so only for trivially destructible types.
+		template <class T, class... Args>
+		T* New(Args&&... args)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed.");
+			return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		// Default initialized, so uninitialized for trivial T.
+		template <class T>
+		T* NewArray(std::size_t count)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed.");
+			return new (Allocate(sizeof(T) * count, alignof(T))) T[count];
+		}
+
+		Marker GetMarker() const noexcept
+		{
+			return { current, position };
+		}
+
+		// Free everything allocated after marker, taken from this arena. Scopes rewind in LIFO order.
+		void Rewind(Marker marker) noexcept
+		{
+			current = marker.block;
+			position = marker.position;
+			end = current ? current->End() : nullptr;
+		}
+
+		void Reset() noexcept
+		{
+			Rewind({ nullptr, nullptr });
+		}
+
+		Upstream& GetUpstream() noexcept
+		{
+			return blocks.E0();
+		}
+
+	private:
+		static unsigned char* Align(unsigned char* p, std::size_t alignment) noexcept
+		{
+			std::uintptr_t const address = reinterpret_cast<std::uintptr_t>(p);
+			return p + ((alignment - address % alignment) % alignment);
+		}
+
+		// Move to the next kept block if the allocation fits there, otherwise insert a new block after the current one.
+		unsigned char* Grow(std::size_t size, std::size_t alignment)
+		{
+			Block* next = current ? current->next : blocks.E1();
+			if (next)
+			{
+				unsigned char* p = Align(next->Begin(), alignment);
+				if (p <= next->End() && static_cast<std::size_t>(next->End() - p) >= size)
+				{
+					Enter(next);
+					return p;
+				}
+			}
+
+			std::size_t const padding = alignment > alignof(std::max_align_t) ? alignment : 0;
+			std::size_t const required = HeaderSize + padding + size;
+			std::size_t const allocated = required > blockSize ? required : blockSize;
+			Block* block = static_cast<Block*>(blocks.E0().Allocate(allocated));
+			block->size = allocated;
+			block->next = next;
+			if (current)
+			{
+				current->next = block;
+			}
+			else
+			{
+				blocks.E1() = block;
+			}
+			Enter(block);
+			return Align(block->Begin(), alignment);
+		}
+
+		void Enter(Block* block) noexcept
+		{
+			current = block;
+			position = block->Begin();
+			end = block->End();
+		}
+
+	private:
+		// upstream and the first block.
+		CompressedPair<Upstream, Block*> blocks;
+		Block* current = nullptr;
+		unsigned char* position = nullptr;
+		unsigned char* end = nullptr;
+		std::size_t const blockSize;
+	};
+
+	using ArenaAllocator = BasicArenaAllocator<>;
+
+	/*
+	*	Rewinds arena to the current marker at scope exit, Dismiss() keeps the allocations.
+	*/
+	template <class Arena>
+	auto CreateArenaScope(Arena& arena)
+	{
+		return CreateScopeGuard([&arena, marker = arena.GetMarker()]()
+		{
+			arena.Rewind(marker);
+		});
+	}
+
+	/*
+	*	Standard allocator over an arena, deallocate does nothing, the memory goes with the arena's next Rewind().
+	*/
+	template <class T, class Arena = ArenaAllocator>
+	struct ArenaStlAllocator
+	{
+		using value_type = T;
+
+		Arena* arena;
+
+		explicit ArenaStlAllocator(Arena& arena) noexcept : arena(&arena)
+		{
+		}
+
+		template <class U>
+		ArenaStlAllocator(ArenaStlAllocator<U, Arena> const& other) noexcept : arena(other.arena)
+		{
+		}
+
+		T* allocate(std::size_t n)
+		{
+			return static_cast<T*>(arena->Allocate(sizeof(T) * n, alignof(T)));
+		}
+
+		void deallocate(T*, std::size_t) noexcept
+		{
+		}
+
+		template <class U>
+		bool operator==(ArenaStlAllocator<U, Arena> const& other) const noexcept
+		{
+			return arena == other.arena;
+		}
+
+		template <class U>
+		bool operator!=(ArenaStlAllocator<U, Arena> const& other) const noexcept
+		{
+			return arena != other.arena;
+		}
+	};
+}
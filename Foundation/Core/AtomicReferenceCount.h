@@ -0,0 +1,177 @@
+#pragma once
+#include "BasicType.h"
+#include "ReferenceCount.h"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace X
+{
+	/*
+	*	ReferenceCountPtr slot shared between threads, lock free with a split reference count.
+	*	The slot packs the pointer with a local count of loads in flight into one 64 bit word.
+	*	Load() increments the local count and then the object counter, then gives the local count back,
+	*	or, if the slot changed meanwhile, drops the reference the replacing thread moved to the object counter on its behalf.
+	*	Hot swap of immutable snapshots, readers Load() and writers Store() a new snapshot, the old one goes with its last reader.
+	*	Pointers must fit in 48 bits on 64 bit targets, which holds for user space on x86-64 and ARM64.
+	*/
+	template <class T>
+	class AtomicReferenceCountPtr
+	{
+	public:
+		~AtomicReferenceCountPtr() noexcept
+		{
+			uint64 const w = word.load(std::memory_order_acquire);
+			assert(LocalCount(w) == 0);
+			if (T* p = Pointer(w))
+			{
+				p->DecreaseReference();
+			}
+		}
+
+		constexpr AtomicReferenceCountPtr() noexcept = default;
+
+		explicit constexpr AtomicReferenceCountPtr(nullptr_t) noexcept
+		{
+		}
+
+		explicit AtomicReferenceCountPtr(ReferenceCountPtr<T> desired) noexcept : word(Pack(desired.Extract()))
+		{
+		}
+
+		explicit AtomicReferenceCountPtr(T* p, Ownership::AcquireT) noexcept : AtomicReferenceCountPtr(ReferenceCountPtr<T>(p, Ownership::Acquire))
+		{
+		}
+
+		explicit AtomicReferenceCountPtr(T* p, Ownership::TransferT) noexcept : AtomicReferenceCountPtr(ReferenceCountPtr<T>(p, Ownership::Transfer))
+		{
+		}
+
+		AtomicReferenceCountPtr(AtomicReferenceCountPtr const&) = delete;
+		AtomicReferenceCountPtr& operator=(AtomicReferenceCountPtr const&) = delete;
+
+		bool IsLockFree() const noexcept
+		{
+			return word.is_lock_free();
+		}
+
+		ReferenceCountPtr<T> Load() const noexcept
+		{
+			// announce the load, the slot keeps the object alive while the local count is held.
+			uint64 const w = word.fetch_add(LocalOne, std::memory_order_acquire);
+			assert(LocalCount(w) + 1 < (uint64(1) << (64 - PointerBits)));
+			T* p = Pointer(w);
+			if (p)
+			{
+				p->IncreaseReference();
+			}
+
+			// local counts are interchangeable, if the same object was stored again giving back another load's count is fine,
+			// that load then finds none and drops its object reference instead.
+			uint64 current = w + LocalOne;
+			while (Pointer(current) == p && LocalCount(current) > 0)
+			{
+				if (word.compare_exchange_weak(current, current - LocalOne, std::memory_order_relaxed))
+				{
+					return ReferenceCountPtr<T>(p, Ownership::Transfer);
+				}
+			}
+			// replaced meanwhile, the replacing thread moved the local count to the object counter.
+			if (p)
+			{
+				p->DecreaseReference();
+			}
+			return ReferenceCountPtr<T>(p, Ownership::Transfer);
+		}
+
+		void Store(ReferenceCountPtr<T> desired) noexcept
+		{
+			Exchange(std::move(desired));
+		}
+
+		void Store(nullptr_t) noexcept
+		{
+			Exchange(ReferenceCountPtr<T>());
+		}
+
+		void Store(T* p, Ownership::AcquireT) noexcept
+		{
+			Exchange(ReferenceCountPtr<T>(p, Ownership::Acquire));
+		}
+
+		void Store(T* p, Ownership::TransferT) noexcept
+		{
+			Exchange(ReferenceCountPtr<T>(p, Ownership::Transfer));
+		}
+
+		ReferenceCountPtr<T> Exchange(ReferenceCountPtr<T> desired) noexcept
+		{
+			uint64 const w = word.exchange(Pack(desired.Extract()), std::memory_order_acq_rel);
+			return Detach(w);
+		}
+
+		/*
+		*	Replace the slot with desired if it still points to expected's object, otherwise load the current value into expected.
+		*/
+		bool CompareExchange(ReferenceCountPtr<T>& expected, ReferenceCountPtr<T> desired) noexcept
+		{
+			uint64 const packed = Pack(desired.Get());
+			uint64 current = word.load(std::memory_order_relaxed);
+			while (Pointer(current) == expected.Get())
+			{
+				// a failure from a changed local count only retries.
+				if (word.compare_exchange_weak(current, packed, std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					desired.Extract();
+					Detach(current);
+					return true;
+				}
+			}
+			expected = Load();
+			return false;
+		}
+
+	private:
+		static constexpr uint32 PointerBits = sizeof(void*) == 8 ? 48 : 32;
+		static constexpr uint64 PointerMask = (uint64(1) << PointerBits) - 1;
+		static constexpr uint64 LocalOne = uint64(1) << PointerBits;
+
+		static uint64 Pack(T* p) noexcept
+		{
+			uint64 const w = static_cast<uint64>(reinterpret_cast<std::uintptr_t>(p));
+			assert((w & ~PointerMask) == 0);
+			return w;
+		}
+
+		static T* Pointer(uint64 w) noexcept
+		{
+			return reinterpret_cast<T*>(static_cast<std::uintptr_t>(w & PointerMask));
+		}
+
+		static uint64 LocalCount(uint64 w) noexcept
+		{
+			return w >> PointerBits;
+		}
+
+		// Take the slot's reference out of a word just removed, with the references owed to loads in flight.
+		static ReferenceCountPtr<T> Detach(uint64 w) noexcept
+		{
+			T* p = Pointer(w);
+			if (p)
+			{
+				for (uint64 i = LocalCount(w); i > 0; --i)
+				{
+					p->IncreaseReference();
+				}
+			}
+			return ReferenceCountPtr<T>(p, Ownership::Transfer);
+		}
+
+	private:
+		mutable std::atomic<uint64> word = 0;
+	};
+
+	template <class T>
+	using AtomicPtr = AtomicReferenceCountPtr<T>;
+}
@@ -0,0 +1,353 @@
+#pragma once
+#include "BasicType.h"
+#include "BitFlag.h"
+#include "Utility.h"
+#include "Math/SIMD.h"
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace X
+{
+	/*
+	*	Selections over columns are bitmasks, bit (i % 32) of word (i / 32) is set when element i is selected, same layout as the culling visibility.
+	*/
+	constexpr uint32 SelectionWordBits = 32;
+
+	constexpr uint32 SelectionWordCount(uint32 count) noexcept { return (count + SelectionWordBits - 1) / SelectionWordBits; }
+
+	/*
+	*	Writes the indices of selected elements in ascending order, returns how many were written.
+	*	indices must hold count elements in the worst case.
+	*/
+	inline uint32 CompactSelection(uint32* indices, uint32 const* selection, uint32 count) noexcept
+	{
+		uint32 written = 0;
+		for (uint32 word = 0; word < SelectionWordCount(count); ++word)
+		{
+			uint32 bits = selection[word];
+			while (bits != 0)
+			{
+				indices[written++] = word * SelectionWordBits + CountTrailingZeros(bits);
+				bits &= bits - 1;
+			}
+		}
+		return written;
+	}
+
+	namespace Detail
+	{
+		// Bit i is set when (p[i] & mask) == target, for the 32 elements at p, which is aligned to 32 * sizeof(U).
+		template <class U>
+		uint32 MatchWord(U const* p, U mask, U target) noexcept
+		{
+#if defined(X_SIMD_AVX2)
+			__m256i const m = sizeof(U) == 1 ? _mm256_set1_epi8(static_cast<char>(mask)) : sizeof(U) == 2 ? _mm256_set1_epi16(static_cast<short>(mask)) : sizeof(U) == 4 ? _mm256_set1_epi32(static_cast<int>(mask)) : _mm256_set1_epi64x(static_cast<long long>(mask));
+			__m256i const t = sizeof(U) == 1 ? _mm256_set1_epi8(static_cast<char>(target)) : sizeof(U) == 2 ? _mm256_set1_epi16(static_cast<short>(target)) : sizeof(U) == 4 ? _mm256_set1_epi32(static_cast<int>(target)) : _mm256_set1_epi64x(static_cast<long long>(target));
+			auto match = [p, m, t](uint32 r) noexcept
+			{
+				__m256i const v = _mm256_and_si256(_mm256_load_si256(reinterpret_cast<__m256i const*>(p) + r), m);
+				if constexpr (sizeof(U) == 1) { return _mm256_cmpeq_epi8(v, t); }
+				else if constexpr (sizeof(U) == 2) { return _mm256_cmpeq_epi16(v, t); }
+				else if constexpr (sizeof(U) == 4) { return _mm256_cmpeq_epi32(v, t); }
+				else { return _mm256_cmpeq_epi64(v, t); }
+			};
+			if constexpr (sizeof(U) == 1)
+			{
+				return static_cast<uint32>(_mm256_movemask_epi8(match(0)));
+			}
+			else if constexpr (sizeof(U) == 2)
+			{
+				// packs works per 128 bit half, the permute restores the element order.
+				__m256i const packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(match(0), match(1)), 0xD8);
+				return static_cast<uint32>(_mm256_movemask_epi8(packed));
+			}
+			else if constexpr (sizeof(U) == 4)
+			{
+				uint32 bits = 0;
+				for (uint32 r = 0; r < 4; ++r)
+				{
+					bits |= static_cast<uint32>(_mm256_movemask_ps(_mm256_castsi256_ps(match(r)))) << (r * 8);
+				}
+				return bits;
+			}
+			else
+			{
+				uint32 bits = 0;
+				for (uint32 r = 0; r < 8; ++r)
+				{
+					bits |= static_cast<uint32>(_mm256_movemask_pd(_mm256_castsi256_pd(match(r)))) << (r * 4);
+				}
+				return bits;
+			}
+#elif defined(X_SIMD_SSE41)
+			__m128i const m = sizeof(U) == 1 ? _mm_set1_epi8(static_cast<char>(mask)) : sizeof(U) == 2 ? _mm_set1_epi16(static_cast<short>(mask)) : sizeof(U) == 4 ? _mm_set1_epi32(static_cast<int>(mask)) : _mm_set1_epi64x(static_cast<long long>(mask));
+			__m128i const t = sizeof(U) == 1 ? _mm_set1_epi8(static_cast<char>(target)) : sizeof(U) == 2 ? _mm_set1_epi16(static_cast<short>(target)) : sizeof(U) == 4 ? _mm_set1_epi32(static_cast<int>(target)) : _mm_set1_epi64x(static_cast<long long>(target));
+			auto match = [p, m, t](uint32 r) noexcept
+			{
+				__m128i const v = _mm_and_si128(_mm_load_si128(reinterpret_cast<__m128i const*>(p) + r), m);
+				if constexpr (sizeof(U) == 1) { return _mm_cmpeq_epi8(v, t); }
+				else if constexpr (sizeof(U) == 2) { return _mm_cmpeq_epi16(v, t); }
+				else if constexpr (sizeof(U) == 4) { return _mm_cmpeq_epi32(v, t); }
+				else { return _mm_cmpeq_epi64(v, t); }
+			};
+			uint32 bits = 0;
+			if constexpr (sizeof(U) == 1)
+			{
+				for (uint32 r = 0; r < 2; ++r)
+				{
+					bits |= static_cast<uint32>(_mm_movemask_epi8(match(r))) << (r * 16);
+				}
+			}
+			else if constexpr (sizeof(U) == 2)
+			{
+				for (uint32 r = 0; r < 4; r += 2)
+				{
+					bits |= static_cast<uint32>(_mm_movemask_epi8(_mm_packs_epi16(match(r), match(r + 1)))) << (r * 8);
+				}
+			}
+			else if constexpr (sizeof(U) == 4)
+			{
+				for (uint32 r = 0; r < 8; ++r)
+				{
+					bits |= static_cast<uint32>(_mm_movemask_ps(_mm_castsi128_ps(match(r)))) << (r * 4);
+				}
+			}
+			else
+			{
+				for (uint32 r = 0; r < 16; ++r)
+				{
+					bits |= static_cast<uint32>(_mm_movemask_pd(_mm_castsi128_pd(match(r)))) << (r * 2);
+				}
+			}
+			return bits;
+#else
+			uint32 bits = 0;
+			for (uint32 i = 0; i < SelectionWordBits; ++i)
+			{
+				bits |= static_cast<uint32>((p[i] & mask) == target) << i;
+			}
+			return bits;
+#endif
+		}
+	}
+
+	/*
+	*	Column of BitFlag<E> stored as raw bits, filtered a selection word (32 flags) at a time with SIMD compares,
+	*	16 or 32 flags per instruction for 2 and 1 byte enums with AVX2.
+	*	Storage is aligned and padded to whole selection words, filters clear the bits past Size().
+	*/
+	template <class E>
+	class BitFlagColumn
+	{
+	public:
+		using Word = std::make_unsigned_t<std::underlying_type_t<E>>;
+		static constexpr uint32 Alignment = 64;
+		static constexpr uint32 Padding = SelectionWordBits;
+
+		BitFlagColumn() noexcept = default;
+
+		explicit BitFlagColumn(uint32 size) { Resize(size); }
+
+		BitFlagColumn(BitFlagColumn const& other)
+		{
+			Resize(other.size);
+			if (size > 0)
+			{
+				std::memcpy(data, other.data, sizeof(Word) * size);
+			}
+		}
+
+		BitFlagColumn(BitFlagColumn&& other) noexcept : data(other.data), size(other.size), capacity(other.capacity)
+		{
+			other.data = nullptr;
+			other.size = 0;
+			other.capacity = 0;
+		}
+
+		BitFlagColumn& operator=(BitFlagColumn const& other)
+		{
+			if (this != &other)
+			{
+				Resize(other.size);
+				if (size > 0)
+				{
+					std::memcpy(data, other.data, sizeof(Word) * size);
+				}
+			}
+			return *this;
+		}
+
+		BitFlagColumn& operator=(BitFlagColumn&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Release();
+				data = other.data;
+				size = other.size;
+				capacity = other.capacity;
+				other.data = nullptr;
+				other.size = 0;
+				other.capacity = 0;
+			}
+			return *this;
+		}
+
+		~BitFlagColumn() noexcept
+		{
+			Release();
+		}
+
+		uint32 Size() const noexcept { return size; }
+		uint32 Capacity() const noexcept { return capacity; }
+		bool Empty() const noexcept { return size == 0; }
+
+		Word* Data() noexcept { return data; }
+		Word const* Data() const noexcept { return data; }
+
+		BitFlag<E> Get(uint32 index) const noexcept
+		{
+			assert(index < size);
+			return BitFlag<E>(E(data[index]));
+		}
+
+		void Set(uint32 index, BitFlag<E> value) noexcept
+		{
+			assert(index < size);
+			data[index] = static_cast<Word>(value.UnderlyingValue());
+		}
+
+		void PushBack(BitFlag<E> value)
+		{
+			if (size == capacity)
+			{
+				Reserve(capacity == 0 ? Padding : capacity * 2);
+			}
+			data[size++] = static_cast<Word>(value.UnderlyingValue());
+		}
+
+		void Clear() noexcept
+		{
+			size = 0;
+		}
+
+		void Reserve(uint32 newCapacity)
+		{
+			newCapacity = (newCapacity + Padding - 1) / Padding * Padding;
+			if (newCapacity <= capacity)
+			{
+				return;
+			}
+
+			Word* newData = static_cast<Word*>(::operator new(sizeof(Word) * newCapacity, std::align_val_t(Alignment)));
+			std::memset(newData, 0, sizeof(Word) * newCapacity);
+			if (size > 0)
+			{
+				std::memcpy(newData, data, sizeof(Word) * size);
+			}
+			Release();
+			data = newData;
+			capacity = newCapacity;
+		}
+
+		// New elements are empty flags.
+		void Resize(uint32 newSize)
+		{
+			Reserve(newSize);
+			if (newSize > size)
+			{
+				std::memset(data + size, 0, sizeof(Word) * (newSize - size));
+			}
+			size = newSize;
+		}
+
+		/*
+		*	Filters write SelectionWordCount(Size()) words of selection.
+		*/
+		// Elements containing every bit of mask.
+		void FilterContainsAll(BitFlag<E> mask, uint32* selection) const noexcept
+		{
+			Word const m = static_cast<Word>(mask.UnderlyingValue());
+			Filter(selection, m, m, 0);
+		}
+
+		// Elements containing at least one bit of mask.
+		void FilterContainsAny(BitFlag<E> mask, uint32* selection) const noexcept
+		{
+			Filter(selection, static_cast<Word>(mask.UnderlyingValue()), 0, ~0u);
+		}
+
+		// Elements containing no bit of mask.
+		void FilterExcludes(BitFlag<E> mask, uint32* selection) const noexcept
+		{
+			Filter(selection, static_cast<Word>(mask.UnderlyingValue()), 0, 0);
+		}
+
+		// Set bits on the selected elements.
+		void SetBits(uint32 const* selection, BitFlag<E> bits) noexcept
+		{
+			Word const b = static_cast<Word>(bits.UnderlyingValue());
+			Apply(selection, [b](Word& w) { w |= b; });
+		}
+
+		void UnsetBits(uint32 const* selection, BitFlag<E> bits) noexcept
+		{
+			Word const b = static_cast<Word>(~bits.UnderlyingValue());
+			Apply(selection, [b](Word& w) { w &= b; });
+		}
+
+	private:
+		// selection bits are ((data & mask) == target) ^ invert.
+		void Filter(uint32* selection, Word mask, Word target, uint32 invert) const noexcept
+		{
+			uint32 const words = SelectionWordCount(size);
+			for (uint32 word = 0; word < words; ++word)
+			{
+				selection[word] = Detail::MatchWord<Word>(data + word * SelectionWordBits, mask, target) ^ invert;
+			}
+			if (size % SelectionWordBits != 0)
+			{
+				selection[words - 1] &= (1u << (size % SelectionWordBits)) - 1;
+			}
+		}
+
+		// Full words run a plain loop the compiler vectorizes, sparse ones visit their set bits.
+		template <class F>
+		void Apply(uint32 const* selection, F&& f) noexcept
+		{
+			for (uint32 word = 0; word < SelectionWordCount(size); ++word)
+			{
+				Word* p = data + word * SelectionWordBits;
+				uint32 bits = selection[word];
+				if (bits == ~0u)
+				{
+					for (uint32 i = 0; i < SelectionWordBits; ++i)
+					{
+						f(p[i]);
+					}
+					continue;
+				}
+				while (bits != 0)
+				{
+					f(p[CountTrailingZeros(bits)]);
+					bits &= bits - 1;
+				}
+			}
+		}
+
+		void Release() noexcept
+		{
+			if (data)
+			{
+				::operator delete(data, std::align_val_t(Alignment));
+				data = nullptr;
+			}
+		}
+
+	private:
+		Word* data = nullptr;
+		uint32 size = 0;
+		uint32 capacity = 0;
+	};
+}
@@ -0,0 +1,366 @@
+#pragma once
+#include "BasicType.h"
+#include "Utility.h"
+#include "Math/SIMD.h"
+#include <cassert>
+#include <initializer_list>
+#include <type_traits>
+
+namespace X
+{
+	/*
+	*	Fixed size set of N bits with the BitFlag vocabulary, for masks wider than 64 bits.
+	*	Runtime set operations and tests go through the widest SIMD::BitPackOf register dividing the word count, constant evaluation stays scalar.
+	*	Bits past N are always 0.
+	*/
+	template <uint32 N>
+	class BitSet
+	{
+		static_assert(N > 0, "BitSet needs at least 1 bit.");
+
+	public:
+		static constexpr uint32 BitCount = N;
+		static constexpr uint32 WordCount = (N + 63) / 64;
+		using Pack = typename SIMD::BitPackOf<WordCount>::Type;
+
+	public:
+		constexpr BitSet() noexcept = default;
+
+		constexpr BitSet(std::initializer_list<uint32> bits) noexcept
+		{
+			for (uint32 bit : bits)
+			{
+				Set(bit);
+			}
+		}
+
+		static constexpr BitSet All() noexcept
+		{
+			return Complement(BitSet());
+		}
+
+		constexpr bool Contains(uint32 bit) const noexcept
+		{
+			assert(bit < N);
+			return (words[bit / 64] & (uint64(1) << (bit % 64))) != 0;
+		}
+
+		constexpr void Set(uint32 bit) noexcept
+		{
+			assert(bit < N);
+			words[bit / 64] |= uint64(1) << (bit % 64);
+		}
+
+		constexpr void Unset(uint32 bit) noexcept
+		{
+			assert(bit < N);
+			words[bit / 64] &= ~(uint64(1) << (bit % 64));
+		}
+
+		constexpr void SetBits(BitSet const& bits) noexcept
+		{
+			*this = Union(*this, bits);
+		}
+
+		constexpr void UnsetBits(BitSet const& bits) noexcept
+		{
+			*this = Difference(*this, bits);
+		}
+
+		constexpr void Clear() noexcept
+		{
+			for (uint64& word : words)
+			{
+				word = 0;
+			}
+		}
+
+		// true if every bit of bits is set.
+		constexpr bool ContainsAll(BitSet const& bits) const noexcept
+		{
+			if (!IsConstantEvaluated())
+			{
+				for (uint32 i = 0; i < WordCount; i += Pack::Words)
+				{
+					if (!Pack::ContainsAll(Pack::Load(words + i), Pack::Load(bits.words + i)))
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+			for (uint32 i = 0; i < WordCount; ++i)
+			{
+				if ((bits.words[i] & ~words[i]) != 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		constexpr bool ContainsAny(BitSet const& bits) const noexcept
+		{
+			if (!IsConstantEvaluated())
+			{
+				for (uint32 i = 0; i < WordCount; i += Pack::Words)
+				{
+					if (Pack::Intersects(Pack::Load(words + i), Pack::Load(bits.words + i)))
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+			for (uint32 i = 0; i < WordCount; ++i)
+			{
+				if ((bits.words[i] & words[i]) != 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		constexpr bool Empty() const noexcept
+		{
+			if (!IsConstantEvaluated())
+			{
+				for (uint32 i = 0; i < WordCount; i += Pack::Words)
+				{
+					if (!Pack::IsZero(Pack::Load(words + i)))
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+			for (uint64 word : words)
+			{
+				if (word != 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Number of set bits.
+		uint32 Count() const noexcept
+		{
+			uint32 count = 0;
+			for (uint64 word : words)
+			{
+				count += PopCount(word);
+			}
+			return count;
+		}
+
+		// f(uint32 bit) for each set bit in ascending order.
+		template <class F>
+		void ForEachSetBit(F&& f) const
+		{
+			for (uint32 i = 0; i < WordCount; ++i)
+			{
+				for (uint64 word = words[i]; word != 0; word &= word - 1)
+				{
+					f(i * 64 + CountTrailingZeros(word));
+				}
+			}
+		}
+
+		constexpr uint64 Word(uint32 index) const noexcept
+		{
+			assert(index < WordCount);
+			return words[index];
+		}
+
+		friend constexpr BitSet Union(BitSet const& l, BitSet const& r) noexcept
+		{
+			return Combine(l, r, [](auto p, auto q) { return Pack::Or(p, q); }, [](uint64 p, uint64 q) { return p | q; });
+		}
+
+		friend constexpr BitSet Intersection(BitSet const& l, BitSet const& r) noexcept
+		{
+			return Combine(l, r, [](auto p, auto q) { return Pack::And(p, q); }, [](uint64 p, uint64 q) { return p & q; });
+		}
+
+		// Bits of l not in r.
+		friend constexpr BitSet Difference(BitSet const& l, BitSet const& r) noexcept
+		{
+			return Combine(l, r, [](auto p, auto q) { return Pack::AndNot(p, q); }, [](uint64 p, uint64 q) { return p & ~q; });
+		}
+
+		friend constexpr BitSet SymmetricDifference(BitSet const& l, BitSet const& r) noexcept
+		{
+			return Combine(l, r, [](auto p, auto q) { return Pack::Xor(p, q); }, [](uint64 p, uint64 q) { return p ^ q; });
+		}
+
+		friend constexpr BitSet Complement(BitSet const& e) noexcept
+		{
+			BitSet result;
+			for (uint32 i = 0; i < WordCount; ++i)
+			{
+				result.words[i] = ~e.words[i];
+			}
+			result.words[WordCount - 1] &= LastWordMask;
+			return result;
+		}
+
+		friend constexpr bool operator==(BitSet const& l, BitSet const& r) noexcept
+		{
+			return SymmetricDifference(l, r).Empty();
+		}
+
+		friend constexpr bool operator!=(BitSet const& l, BitSet const& r) noexcept
+		{
+			return !(l == r);
+		}
+
+		friend constexpr BitSet operator|(BitSet const& l, BitSet const& r) noexcept { return Union(l, r); }
+		friend constexpr BitSet operator&(BitSet const& l, BitSet const& r) noexcept { return Intersection(l, r); }
+		friend constexpr BitSet operator^(BitSet const& l, BitSet const& r) noexcept { return SymmetricDifference(l, r); }
+		friend constexpr BitSet operator~(BitSet const& e) noexcept { return Complement(e); }
+
+		constexpr BitSet& operator|=(BitSet const& r) noexcept { return *this = Union(*this, r); }
+		constexpr BitSet& operator&=(BitSet const& r) noexcept { return *this = Intersection(*this, r); }
+		constexpr BitSet& operator^=(BitSet const& r) noexcept { return *this = SymmetricDifference(*this, r); }
+
+	private:
+		static constexpr uint64 LastWordMask = N % 64 == 0 ? ~uint64(0) : (uint64(1) << (N % 64)) - 1;
+
+		template <class PackOp, class WordOp>
+		static constexpr BitSet Combine(BitSet const& l, BitSet const& r, PackOp packOp, WordOp wordOp) noexcept
+		{
+			BitSet result;
+			if (!IsConstantEvaluated())
+			{
+				for (uint32 i = 0; i < WordCount; i += Pack::Words)
+				{
+					Pack::Store(result.words + i, packOp(Pack::Load(l.words + i), Pack::Load(r.words + i)));
+				}
+				return result;
+			}
+			for (uint32 i = 0; i < WordCount; ++i)
+			{
+				result.words[i] = wordOp(l.words[i], r.words[i]);
+			}
+			return result;
+		}
+
+	private:
+		// independent of the enabled instruction sets, so the layout is the same in every translation unit.
+		alignas(WordCount % 4 == 0 ? 32 : WordCount % 2 == 0 ? 16 : 8) uint64 words[WordCount] = {};
+	};
+
+	/*
+	*	Indices of the sets containing every bit of required and none of excluded, e.g. archetypes matching a query.
+	*	indices holds up to count entries, returns the number written.
+	*/
+	template <uint32 N>
+	uint32 FilterSets(BitSet<N> const* sets, uint32 count, BitSet<N> const& required, BitSet<N> const& excluded, uint32* indices) noexcept
+	{
+		uint32 written = 0;
+		for (uint32 i = 0; i < count; ++i)
+		{
+			indices[written] = i;
+			written += sets[i].ContainsAll(required) && !sets[i].ContainsAny(excluded);
+		}
+		return written;
+	}
+
+	/*
+	*	BitSet indexed by enumerators, for flag enums with more values than the widest integer.
+	*	Enumerators are bit indices 0 to N - 1, not masks as for BitFlag.
+	*/
+	template <class E, uint32 N, class = std::enable_if_t<std::is_enum_v<E>>>
+	class WideBitFlag
+	{
+	public:
+		constexpr WideBitFlag() noexcept = default;
+
+		constexpr WideBitFlag(E e) noexcept
+		{
+			bits.Set(Index(e));
+		}
+
+		constexpr WideBitFlag(std::initializer_list<E> es) noexcept
+		{
+			for (E e : es)
+			{
+				bits.Set(Index(e));
+			}
+		}
+
+		constexpr explicit WideBitFlag(BitSet<N> const& bits) noexcept : bits(bits)
+		{
+		}
+
+		constexpr BitSet<N> const& Bits() const noexcept
+		{
+			return bits;
+		}
+
+		constexpr bool Contains(E e) const noexcept
+		{
+			return bits.Contains(Index(e));
+		}
+
+		constexpr bool ContainsAll(WideBitFlag const& flags) const noexcept
+		{
+			return bits.ContainsAll(flags.bits);
+		}
+
+		constexpr bool ContainsAny(WideBitFlag const& flags) const noexcept
+		{
+			return bits.ContainsAny(flags.bits);
+		}
+
+		constexpr bool Empty() const noexcept
+		{
+			return bits.Empty();
+		}
+
+		uint32 Count() const noexcept
+		{
+			return bits.Count();
+		}
+
+		constexpr void SetBits(WideBitFlag const& flags) noexcept
+		{
+			bits.SetBits(flags.bits);
+		}
+
+		constexpr void UnsetBits(WideBitFlag const& flags) noexcept
+		{
+			bits.UnsetBits(flags.bits);
+		}
+
+		// f(E e) for each set enumerator in ascending order.
+		template <class F>
+		void ForEachSetBit(F&& f) const
+		{
+			bits.ForEachSetBit([&f](uint32 bit) { f(static_cast<E>(bit)); });
+		}
+
+		friend constexpr WideBitFlag Union(WideBitFlag const& l, WideBitFlag const& r) noexcept { return WideBitFlag(Union(l.bits, r.bits)); }
+		friend constexpr WideBitFlag Intersection(WideBitFlag const& l, WideBitFlag const& r) noexcept { return WideBitFlag(Intersection(l.bits, r.bits)); }
+		friend constexpr WideBitFlag Complement(WideBitFlag const& e) noexcept { return WideBitFlag(Complement(e.bits)); }
+
+		friend constexpr WideBitFlag operator|(WideBitFlag const& l, WideBitFlag const& r) noexcept { return Union(l, r); }
+		friend constexpr WideBitFlag operator&(WideBitFlag const& l, WideBitFlag const& r) noexcept { return Intersection(l, r); }
+		friend constexpr WideBitFlag operator~(WideBitFlag const& e) noexcept { return Complement(e); }
+
+		friend constexpr bool operator==(WideBitFlag const& l, WideBitFlag const& r) noexcept { return l.bits == r.bits; }
+		friend constexpr bool operator!=(WideBitFlag const& l, WideBitFlag const& r) noexcept { return l.bits != r.bits; }
+
+	private:
+		static constexpr uint32 Index(E e) noexcept
+		{
+			return static_cast<uint32>(e);
+		}
+
+	private:
+		BitSet<N> bits;
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <type_traits>
+#include <utility>
 
 namespace X
 {
@@ -77,7 +78,7 @@ namespace X
 			constexpr CompressedPairImpl() = default;
 
 			template <class TT0, class TT1>
-			constexpr CompressedPairImpl(TT0&& t0, TT1&& t1) : t0(std::forward<TT0>(t0)), T1(std::forward<TT1>(t1))
+			constexpr CompressedPairImpl(TT0&& t0, TT1&& t1) : T1(std::forward<TT1>(t1)), t0(std::forward<TT0>(t0))
 			{
 			}
 
@@ -116,10 +117,12 @@ namespace X
 	template <class T0, class T1>
 	struct CompressedPair : Detail::CompressedPairImpl<T0, T1, std::is_empty<T0>::value, std::is_empty<T1>::value>
 	{
+		using Impl = Detail::CompressedPairImpl<T0, T1, std::is_empty<T0>::value, std::is_empty<T1>::value>;
+
 		constexpr CompressedPair() = default;
 
 		template <class TT0, class TT1>
-		constexpr CompressedPair(TT0&& t0, TT1&& t1) : CompressedPairImpl(std::forward<TT0>(t0), std::forward<TT1>(t1))
+		constexpr CompressedPair(TT0&& t0, TT1&& t1) : Impl(std::forward<TT0>(t0), std::forward<TT1>(t1))
 		{
 		}
 	};
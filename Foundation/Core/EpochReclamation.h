@@ -0,0 +1,312 @@
+#pragma once
+#include "BasicType.h"
+#include "ReferenceCount.h"
+#include "ScopeGuard.h"
+#include <atomic>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace X
+{
+	/*
+	*	Epoch based reclamation, see 'Practical lock-freedom', Keir Fraser.
+	*	Readers enter a critical section with EpochGuard and may use raw pointers loaded inside it until they leave.
+	*	Writers unlink an object and Retire() it, it is destroyed once every reader that could have seen it has left.
+	*	Retired objects are destroyed in batches by the retiring thread, every CollectInterval retires or on Collect().
+	*	A domain must outlive the other threads using it, EpochDomain::Global() is the usual one.
+	*/
+	class EpochDomain
+	{
+	public:
+		static constexpr uint32 CollectInterval = 64;
+
+	public:
+		EpochDomain() noexcept = default;
+
+		EpochDomain(EpochDomain const&) = delete;
+		EpochDomain& operator=(EpochDomain const&) = delete;
+
+		// No thread may be inside a critical section, everything retired is destroyed.
+		~EpochDomain() noexcept
+		{
+			// forget the record of this thread, unless its records went already, like the main thread's before the global domain.
+			if (!ThreadRecords::Exited())
+			{
+				std::vector<std::pair<EpochDomain*, Record*>>& entries = LocalRecords().entries;
+				for (auto it = entries.begin(); it != entries.end(); ++it)
+				{
+					if (it->first == this)
+					{
+						entries.erase(it);
+						break;
+					}
+				}
+			}
+
+			Record* record = records.load(std::memory_order_acquire);
+			while (record)
+			{
+				Record* next = record->next;
+				for (Bag& bag : record->bags)
+				{
+					bag.Destroy();
+				}
+				delete record;
+				record = next;
+			}
+		}
+
+		static EpochDomain& Global() noexcept
+		{
+			static EpochDomain domain;
+			return domain;
+		}
+
+		// Nestable, prefer EpochGuard. The first call on a thread allocates its record and may throw.
+		void Enter()
+		{
+			Record& record = LocalRecord();
+			if (record.nesting++ == 0)
+			{
+				record.epoch.store(epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				// the announcement must be visible before any pointer is loaded in the critical section.
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+			}
+		}
+
+		// The record exists since Enter(), nothing is allocated.
+		void Leave() noexcept
+		{
+			Record& record = LocalRecord();
+			assert(record.nesting > 0);
+			if (--record.nesting == 0)
+			{
+				record.epoch.store(Inactive, std::memory_order_release);
+			}
+		}
+
+		/*
+		*	Destroy object with deleter once no critical section can reference it. The object must already be unreachable for new readers.
+		*	Pins the calling thread itself, callers need not be inside a critical section.
+		*/
+		void Retire(void* object, void (*deleter)(void*))
+		{
+			Record& record = LocalRecord();
+			{
+				// pinned, so the epoch moves on by at most one until the object is in the bag of the epoch read.
+				Enter();
+				auto guard = CreateScopeGuard([this]() { Leave(); });
+				uint64 const current = epoch.load(std::memory_order_seq_cst);
+				Bag& bag = record.bags[current % BagCount];
+				if (bag.epoch != current)
+				{
+					// the bag of epoch current - BagCount, safe by now.
+					bag.Destroy();
+					bag.epoch = current;
+				}
+				bag.objects.push_back({ object, deleter });
+			}
+
+			if (++record.retiredSinceCollect >= CollectInterval)
+			{
+				Collect(record);
+			}
+		}
+
+		template <class T>
+		void Retire(T* object)
+		{
+			Retire(const_cast<void*>(static_cast<void const*>(object)), [](void* p) { delete static_cast<T*>(p); });
+		}
+
+		/*
+		*	Advance the epoch if every critical section has caught up, then destroy the calling thread's retired objects that became safe.
+		*/
+		void Collect()
+		{
+			Collect(LocalRecord());
+		}
+
+	private:
+		static constexpr uint64 Inactive = ~uint64(0);
+		// objects retired in epoch e are safe once the epoch reaches e + 2, so three bags rotate.
+		static constexpr uint32 BagCount = 3;
+
+		struct Retired
+		{
+			void* object;
+			void (*deleter)(void*);
+		};
+
+		struct Bag
+		{
+			uint64 epoch = 0;
+			std::vector<Retired> objects;
+
+			void Destroy() noexcept
+			{
+				// deleters may retire more objects, even into this bag.
+				std::vector<Retired> destroying = std::move(objects);
+				objects.clear();
+				for (Retired const& retired : destroying)
+				{
+					retired.deleter(retired.object);
+				}
+				if (objects.empty())
+				{
+					// keep the capacity.
+					destroying.clear();
+					objects.swap(destroying);
+				}
+			}
+		};
+
+		// One per thread and domain, reused by later threads together with the objects left in its bags.
+		struct Record
+		{
+			std::atomic<uint64> epoch = Inactive;
+			std::atomic<bool> used = false;
+			Record* next = nullptr;
+			uint32 nesting = 0;
+			uint32 retiredSinceCollect = 0;
+			Bag bags[BagCount];
+		};
+
+		// Records taken by the current thread, returned to their domains at thread exit.
+		struct ThreadRecords
+		{
+			std::vector<std::pair<EpochDomain*, Record*>> entries;
+
+			~ThreadRecords() noexcept
+			{
+				for (auto const& entry : entries)
+				{
+					assert(entry.second->nesting == 0);
+					entry.second->used.store(false, std::memory_order_release);
+				}
+				Exited() = true;
+			}
+
+			// trivially destructible, still valid after thread local destructors ran.
+			static bool& Exited() noexcept
+			{
+				thread_local bool exited = false;
+				return exited;
+			}
+		};
+
+		static ThreadRecords& LocalRecords() noexcept
+		{
+			thread_local ThreadRecords local;
+			return local;
+		}
+
+		Record& LocalRecord()
+		{
+			ThreadRecords& local = LocalRecords();
+			for (auto const& entry : local.entries)
+			{
+				if (entry.first == this)
+				{
+					return *entry.second;
+				}
+			}
+
+			Record* record = AcquireRecord();
+			local.entries.emplace_back(this, record);
+			return *record;
+		}
+
+		Record* AcquireRecord()
+		{
+			for (Record* record = records.load(std::memory_order_acquire); record; record = record->next)
+			{
+				bool expected = false;
+				if (!record->used.load(std::memory_order_relaxed) && record->used.compare_exchange_strong(expected, true, std::memory_order_acquire))
+				{
+					return record;
+				}
+			}
+
+			Record* record = new Record();
+			record->used.store(true, std::memory_order_relaxed);
+			Record* head = records.load(std::memory_order_relaxed);
+			do
+			{
+				record->next = head;
+			} while (!records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+			return record;
+		}
+
+		void TryAdvance() noexcept
+		{
+			uint64 current = epoch.load(std::memory_order_seq_cst);
+			for (Record* record = records.load(std::memory_order_acquire); record; record = record->next)
+			{
+				uint64 const e = record->epoch.load(std::memory_order_seq_cst);
+				if (e != Inactive && e != current)
+				{
+					return;
+				}
+			}
+			epoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+		}
+
+		void Collect(Record& record)
+		{
+			record.retiredSinceCollect = 0;
+			TryAdvance();
+			uint64 const current = epoch.load(std::memory_order_seq_cst);
+			for (Bag& bag : record.bags)
+			{
+				if (bag.epoch + 2 <= current)
+				{
+					bag.Destroy();
+				}
+			}
+		}
+
+	private:
+		std::atomic<uint64> epoch = 0;
+		std::atomic<Record*> records = nullptr;
+	};
+
+	/*
+	*	Critical section of an epoch domain, raw pointers loaded inside stay valid until it ends.
+	*/
+	class EpochGuard
+	{
+	public:
+		explicit EpochGuard(EpochDomain& domain = EpochDomain::Global()) : domain(domain)
+		{
+			domain.Enter();
+		}
+
+		~EpochGuard() noexcept
+		{
+			domain.Leave();
+		}
+
+		EpochGuard(EpochGuard const&) = delete;
+		EpochGuard& operator=(EpochGuard const&) = delete;
+
+	private:
+		EpochDomain& domain;
+	};
+
+	/*
+	*	Reference counted object whose release is deferred to EpochDomain::Global(), so readers holding a raw pointer inside an EpochGuard stay safe
+	*	and the destructor runs in a batch off the releasing path. Readers must not take new references from such raw pointers.
+	*	Base is one of the reference count bases.
+	*/
+	template <class Base = ReferenceCountBase<true>>
+	struct EpochReclaimed : Base
+	{
+	protected:
+		void OnRelease() noexcept override
+		{
+			EpochDomain::Global().Retire(static_cast<Base*>(this));
+		}
+	};
+}
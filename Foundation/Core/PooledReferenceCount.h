@@ -0,0 +1,179 @@
+#pragma once
+#include "BasicType.h"
+#include "ReferenceCount.h"
+#include "ScopeGuard.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace X
+{
+	/*
+	*	Fixed size allocator for T, one cache per thread carving blocks out of 64KB slabs.
+	*	A block freed by its owning thread goes back to that thread's free list without atomics,
+	*	a block freed by another thread is pushed to the owner's lock free remote list, which the owner takes back in one exchange when its free list runs dry.
+	*	Caches of exited threads are adopted by new threads, slabs are kept for the life of the process.
+	*/
+	template <class T>
+	class SlabPool
+	{
+	public:
+		static constexpr uint32 SlabSize = 64 * 1024;
+
+		static void* Allocate()
+		{
+			Cache* cache = Local();
+			if (!cache->free)
+			{
+				cache->free = cache->remote.exchange(nullptr, std::memory_order_acquire);
+			}
+			if (Block* block = cache->free)
+			{
+				cache->free = block->next;
+				return block->storage;
+			}
+
+			if (cache->end - cache->bump < static_cast<std::ptrdiff_t>(sizeof(Block)))
+			{
+				cache->bump = static_cast<unsigned char*>(::operator new(SlabSize, std::align_val_t(alignof(Block))));
+				cache->end = cache->bump + SlabSize / sizeof(Block) * sizeof(Block);
+			}
+			Block* block = new (cache->bump) Block;
+			cache->bump += sizeof(Block);
+			block->owner = cache;
+			return block->storage;
+		}
+
+		// memory from Allocate() of any thread.
+		static void Free(void* memory) noexcept
+		{
+			Block* block = reinterpret_cast<Block*>(static_cast<unsigned char*>(memory) - offsetof(Block, storage));
+			Cache* owner = block->owner;
+			if (owner == LocalSlot())
+			{
+				block->next = owner->free;
+				owner->free = block;
+				return;
+			}
+
+			Block* head = owner->remote.load(std::memory_order_relaxed);
+			do
+			{
+				block->next = head;
+			} while (!owner->remote.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+	private:
+		struct Cache;
+
+		struct Block
+		{
+			Cache* owner;
+			union
+			{
+				Block* next;
+				alignas(T) unsigned char storage[sizeof(T)];
+			};
+		};
+
+		struct Cache
+		{
+			Block* free = nullptr;
+			std::atomic<Block*> remote = nullptr;
+			unsigned char* bump = nullptr;
+			unsigned char* end = nullptr;
+			Cache* nextOrphan = nullptr;
+		};
+
+		// Orphans the cache at thread exit.
+		struct ThreadExit
+		{
+			~ThreadExit() noexcept
+			{
+				Cache*& cache = LocalSlot();
+				std::lock_guard<std::mutex> lock(Orphans().mutex);
+				cache->nextOrphan = Orphans().head;
+				Orphans().head = cache;
+				cache = nullptr;
+			}
+		};
+
+		struct OrphanList
+		{
+			std::mutex mutex;
+			Cache* head = nullptr;
+		};
+
+		static OrphanList& Orphans() noexcept
+		{
+			static OrphanList orphans;
+			return orphans;
+		}
+
+		// trivially destructible, so frees during other thread local destructors still find it.
+		static Cache*& LocalSlot() noexcept
+		{
+			thread_local Cache* cache = nullptr;
+			return cache;
+		}
+
+		static Cache* Local()
+		{
+			Cache*& cache = LocalSlot();
+			if (!cache)
+			{
+				thread_local ThreadExit exit;
+				(void)exit;
+
+				std::lock_guard<std::mutex> lock(Orphans().mutex);
+				if (Orphans().head)
+				{
+					cache = Orphans().head;
+					Orphans().head = cache->nextOrphan;
+				}
+				else
+				{
+					cache = new Cache();
+				}
+			}
+			return cache;
+		}
+	};
+
+	namespace Detail
+	{
+		// Most derived type of pooled objects, gives the memory back to the pool after destruction.
+		template <class T>
+		struct PooledObject final : T
+		{
+			template <class... Args>
+			explicit PooledObject(Args&&... args) : T(std::forward<Args>(args)...)
+			{
+			}
+
+		protected:
+			void OnRelease() noexcept override
+			{
+				this->~PooledObject();
+				SlabPool<PooledObject>::Free(this);
+			}
+		};
+	}
+
+	/*
+	*	Same as CreatePtr, allocating from SlabPool instead of global new.
+	*	T derives from a reference count base with virtual OnRelease and must not override it, nor be final.
+	*/
+	template <class T, class... Args>
+	ReferenceCountPtr<T> CreatePooledPtr(Args&&... args)
+	{
+		using Object = Detail::PooledObject<T>;
+		void* memory = SlabPool<Object>::Allocate();
+		auto guard = CreateScopeGuard([memory]() { SlabPool<Object>::Free(memory); });
+		Object* object = new (memory) Object(std::forward<Args>(args)...);
+		guard.Dismiss();
+		return ReferenceCountPtr<T>(object, Ownership::Transfer);
+	}
+}
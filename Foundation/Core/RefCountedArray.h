@@ -0,0 +1,205 @@
+#pragma once
+#include "BasicType.h"
+#include "ReferenceCount.h"
+#include "ScopeGuard.h"
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace X
+{
+	/*
+	*	Shared array with the counter, the size and the elements in one allocation, held by ReferenceCountPtr<RefCountedArray<T>>.
+	*	Elements start on an Alignment boundary and the storage is padded to whole Alignment blocks, so SIMD kernels may run to PaddedSize().
+	*	No virtual functions, the release path destroys the elements and frees the block directly.
+	*	Copy on write: MakeUnique() before writing through a possibly shared handle.
+	*/
+	template <class T, bool ThreadSafe = true, uint32 Alignment = 64>
+	class RefCountedArray
+	{
+		static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of 2 and at least alignof(T).");
+
+	public:
+		using Counter = std::conditional_t<ThreadSafe, std::atomic<sint32>, sint32>;
+
+		// Default constructed elements.
+		static ReferenceCountPtr<RefCountedArray> Create(uint32 size)
+		{
+			RefCountedArray* array = Allocate(size);
+			array->Construct([](T* p, uint32) { new (p) T(); });
+			return ReferenceCountPtr<RefCountedArray>(array, Ownership::Transfer);
+		}
+
+		static ReferenceCountPtr<RefCountedArray> Create(uint32 size, T const& value)
+		{
+			RefCountedArray* array = Allocate(size);
+			array->Construct([&value](T* p, uint32) { new (p) T(value); });
+			return ReferenceCountPtr<RefCountedArray>(array, Ownership::Transfer);
+		}
+
+		static ReferenceCountPtr<RefCountedArray> Create(T const* data, uint32 size)
+		{
+			RefCountedArray* array = Allocate(size);
+			array->Construct([data](T* p, uint32 i) { new (p) T(data[i]); });
+			return ReferenceCountPtr<RefCountedArray>(array, Ownership::Transfer);
+		}
+
+		/*
+		*	Replace array with a private copy unless it is the only reference.
+		*/
+		static void MakeUnique(ReferenceCountPtr<RefCountedArray>& array)
+		{
+			if (array && !array->IsUniqueReference())
+			{
+				array = Create(array->Data(), array->Size());
+			}
+		}
+
+		RefCountedArray(RefCountedArray const&) = delete;
+		RefCountedArray& operator=(RefCountedArray const&) = delete;
+
+		uint32 Size() const noexcept { return size; }
+		bool Empty() const noexcept { return size == 0; }
+
+		// Size rounded up to whole Alignment blocks, elements past Size() hold unspecified values.
+		uint32 PaddedSize() const noexcept
+		{
+			static_assert(std::is_trivially_copyable_v<T> && Alignment % sizeof(T) == 0, "PaddedSize() for trivially copyable elements dividing Alignment only.");
+			return static_cast<uint32>(StorageBytes(size) / sizeof(T));
+		}
+
+		T* Data() noexcept { return std::launder(reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(this) + HeaderSize)); }
+		T const* Data() const noexcept { return std::launder(reinterpret_cast<T const*>(reinterpret_cast<unsigned char const*>(this) + HeaderSize)); }
+
+		T& operator[](uint32 index) noexcept { assert(index < size); return Data()[index]; }
+		T const& operator[](uint32 index) const noexcept { assert(index < size); return Data()[index]; }
+
+		T* begin() noexcept { return Data(); }
+		T* end() noexcept { return Data() + size; }
+		T const* begin() const noexcept { return Data(); }
+		T const* end() const noexcept { return Data() + size; }
+
+		bool IsUniqueReference() const noexcept
+		{
+			if constexpr (ThreadSafe)
+			{
+				return counter.load(std::memory_order_acquire) == 1;
+			}
+			else
+			{
+				return counter == 1;
+			}
+		}
+
+		sint32 GetReferenceCount() const noexcept
+		{
+			if constexpr (ThreadSafe)
+			{
+				return counter.load(std::memory_order_relaxed);
+			}
+			else
+			{
+				return counter;
+			}
+		}
+
+		void IncreaseReference() noexcept
+		{
+			if constexpr (ThreadSafe)
+			{
+				counter.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+			{
+				counter += 1;
+			}
+		}
+
+		void DecreaseReference() noexcept
+		{
+			if constexpr (ThreadSafe)
+			{
+				if (Detail::ReleaseReference(counter))
+				{
+					Release();
+				}
+			}
+			else
+			{
+				counter -= 1;
+				if (counter == 0)
+				{
+					Release();
+				}
+			}
+		}
+
+	private:
+		static constexpr std::size_t HeaderSize = (sizeof(Counter) + sizeof(uint32) + Alignment - 1) / Alignment * Alignment;
+
+		explicit RefCountedArray(uint32 size) noexcept : size(size) {}
+		~RefCountedArray() noexcept = default;
+
+		static std::size_t StorageBytes(uint32 size) noexcept
+		{
+			return (sizeof(T) * size + Alignment - 1) / Alignment * Alignment;
+		}
+
+		static RefCountedArray* Allocate(uint32 size)
+		{
+			void* memory = ::operator new(HeaderSize + StorageBytes(size), std::align_val_t(Alignment));
+			return new (memory) RefCountedArray(size);
+		}
+
+		// construct(T* p, uint32 i) builds element i at p, a throw destroys what was built and frees the block.
+		template <class Builder>
+		void Construct(Builder&& construct)
+		{
+			uint32 built = 0;
+			auto guard = CreateScopeGuard([this, &built]()
+			{
+				Destroy(built);
+				Free();
+			});
+			T* data = Data();
+			for (; built < size; ++built)
+			{
+				construct(data + built, built);
+			}
+			guard.Dismiss();
+		}
+
+		void Destroy(uint32 count) noexcept
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				T* data = Data();
+				while (count > 0)
+				{
+					data[--count].~T();
+				}
+			}
+		}
+
+		void Free() noexcept
+		{
+			this->~RefCountedArray();
+			::operator delete(static_cast<void*>(this), std::align_val_t(Alignment));
+		}
+
+		void Release() noexcept
+		{
+			Destroy(size);
+			Free();
+		}
+
+	private:
+		Counter counter = 1;
+		uint32 const size;
+	};
+
+	template <class T, bool ThreadSafe = true, uint32 Alignment = 64>
+	using SharedArray = ReferenceCountPtr<RefCountedArray<T, ThreadSafe, Alignment>>;
+}
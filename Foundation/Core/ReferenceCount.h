@@ -1,9 +1,27 @@
 #pragma once
 #include "BasicType.h"
+#include "Utility.h"
 #include <atomic>
 
 namespace X
 {
+	namespace Detail
+	{
+		/*
+		*	Drops a reference with release order, true when it was the last one.
+		*	The last one then acquires the release sequence of every decrement, same as an acquire fence but visible to thread sanitizers.
+		*/
+		inline bool ReleaseReference(std::atomic<sint32>& counter) noexcept
+		{
+			if (counter.fetch_sub(1, std::memory_order_release) == 1)
+			{
+				(void)counter.load(std::memory_order_acquire);
+				return true;
+			}
+			return false;
+		}
+	}
+
 	// override OnRelease to customize deletion.
 	template <bool ThreadSafe = true>
 	struct ReferenceCountBase;
@@ -50,23 +68,26 @@ namespace X
 			return *this;
 		}
 
+		// acquire, so writes through references released by other threads are visible before copy on write.
 		bool IsUniqueReference() const noexcept
 		{
-			return counter.load() == 1;
+			return counter.load(std::memory_order_acquire) == 1;
 		}
 
 		sint32 GetReferenceCount() const noexcept
 		{
-			return counter.load();
+			return counter.load(std::memory_order_relaxed);
 		}
 
+		// a new reference is made from an existing one, nothing to order.
 		void IncreaseReference() noexcept
 		{
-			counter.fetch_add(1);
+			counter.fetch_add(1, std::memory_order_relaxed);
 		}
+		// release, so every use happens before OnRelease, which acquires the whole release sequence.
 		void DecreaseReference() noexcept
 		{
-			if (counter.fetch_sub(1) == 1)
+			if (Detail::ReleaseReference(counter))
 			{
 				OnRelease();
 			}
@@ -145,12 +166,11 @@ namespace X
 		}
 		void DecreaseReference() noexcept
 		{
-			sint32 c = counter - 1;
-			if (c == 0)
+			counter -= 1;
+			if (counter == 0)
 			{
 				OnRelease();
 			}
-			counter = c;
 		}
 
 		virtual ~ReferenceCountBase() noexcept = 0
@@ -170,6 +190,399 @@ namespace X
 		sint32 counter = 1;
 	};
 
+
+	struct BiasedReferenceCountBase;
+
+	/*
+	*	Per thread list of biased objects whose shared count went negative, see BiasedReferenceCountBase.
+	*/
+	class BiasedReferenceQueue
+	{
+		friend struct BiasedReferenceCountBase;
+
+	public:
+		static BiasedReferenceQueue& Current() noexcept
+		{
+			thread_local BiasedReferenceQueue queue;
+			return queue;
+		}
+
+		/*
+		*	Merge the counts of objects released on other threads, call regularly on every thread creating biased objects, e.g. once per tick.
+		*	Until then such objects are not deleted.
+		*/
+		static void Merge() noexcept
+		{
+			Current().MergePending();
+		}
+
+		~BiasedReferenceQueue() noexcept
+		{
+			MergePending();
+		}
+
+	private:
+		BiasedReferenceQueue() noexcept = default;
+
+		void Push(BiasedReferenceCountBase* object) noexcept;
+		void MergePending() noexcept;
+
+	private:
+		std::atomic<BiasedReferenceCountBase*> pending = nullptr;
+	};
+
+	/*
+	*	Biased reference counting, see 'Biased Reference Counting: Minimizing Atomic Operations in Garbage Collection', Choi et al.
+	*	The creating thread owns a non atomic counter, other threads use an atomic shared counter. The owner merges both when its counter drops to 0.
+	*	If the shared counter goes negative, the references were handed from the owner to other threads and released there,
+	*	so the object is queued to the owner, which merges it in BiasedReferenceQueue::Merge().
+	*	The owner thread must outlive its objects, or at least keep calling Merge() while other threads release them.
+	*	override OnRelease to customize deletion, same as ReferenceCountBase.
+	*/
+	struct BiasedReferenceCountBase
+	{
+		friend class BiasedReferenceQueue;
+
+#ifdef MemoryDebug
+	public:
+		static sint32& Count() noexcept
+		{
+			static sint32 c = 0;
+			return c;
+		}
+
+		BiasedReferenceCountBase() noexcept
+		{
+			Count() += 1;
+		}
+
+#endif // MemoryDebug
+
+	public:
+#ifndef MemoryDebug
+		BiasedReferenceCountBase() noexcept = default;
+#endif // !MemoryDebug
+
+		BiasedReferenceCountBase(BiasedReferenceCountBase const& other) noexcept
+		{
+		}
+
+		BiasedReferenceCountBase(BiasedReferenceCountBase&& other) noexcept
+		{
+		}
+
+		BiasedReferenceCountBase& operator=(BiasedReferenceCountBase const& other) noexcept
+		{
+			return *this;
+		}
+
+		BiasedReferenceCountBase& operator=(BiasedReferenceCountBase&& other) noexcept
+		{
+			return *this;
+		}
+
+		// Exact on the owner thread or after merging, other threads conservatively get false before that.
+		bool IsUniqueReference() const noexcept
+		{
+			if (IsOwnedByCurrentThread())
+			{
+				return biased + SharedCount(shared.load(std::memory_order_acquire)) == 1;
+			}
+			sint32 const s = shared.load(std::memory_order_acquire);
+			return (s & Merged) != 0 && SharedCount(s) == 1;
+		}
+
+		// Same as IsUniqueReference(), other threads only see their part before merging.
+		sint32 GetReferenceCount() const noexcept
+		{
+			sint32 const count = SharedCount(shared.load(std::memory_order_relaxed));
+			return IsOwnedByCurrentThread() ? count + static_cast<sint32>(biased) : count;
+		}
+
+		void IncreaseReference() noexcept
+		{
+			if (IsOwnedByCurrentThread())
+			{
+				biased += 1;
+				return;
+			}
+			shared.fetch_add(SharedOne, std::memory_order_relaxed);
+		}
+
+		void DecreaseReference() noexcept
+		{
+			if (IsOwnedByCurrentThread())
+			{
+				biased -= 1;
+				if (biased == 0 && MergeBiased(false) == Merged)
+				{
+					OnRelease();
+				}
+				return;
+			}
+
+			sint32 const s = shared.fetch_sub(SharedOne, std::memory_order_acq_rel) - SharedOne;
+			if (s == Merged)
+			{
+				OnRelease();
+			}
+			else if ((s & (Merged | Queued)) == 0 && SharedCount(s) < 0)
+			{
+				RequestMerge();
+			}
+		}
+
+		virtual ~BiasedReferenceCountBase() noexcept = 0;
+
+	protected:
+		virtual void OnRelease() noexcept
+		{
+			delete this;
+		}
+
+	private:
+		// shared holds count << 2 and the flags below.
+		static constexpr sint32 Merged = 1;
+		static constexpr sint32 Queued = 2;
+		static constexpr sint32 SharedOne = 4;
+
+		static sint32 SharedCount(sint32 s) noexcept
+		{
+			return s >> 2;
+		}
+
+		// biased is 0 once merged, the owner uses shared from then on.
+		bool IsOwnedByCurrentThread() const noexcept
+		{
+			return owner == &BiasedReferenceQueue::Current() && biased != 0;
+		}
+
+		// Owner only. Moves biased into shared, returns the new shared value, Merged means released.
+		sint32 MergeBiased(bool dequeue) noexcept
+		{
+			sint32 const add = static_cast<sint32>(biased) * SharedOne;
+			biased = 0;
+			sint32 s = shared.load(std::memory_order_relaxed);
+			sint32 desired;
+			do
+			{
+				desired = ((s + add) | Merged) & ~(dequeue ? Queued : 0);
+			} while (!shared.compare_exchange_weak(s, desired, std::memory_order_acq_rel, std::memory_order_relaxed));
+			return desired;
+		}
+
+		// Other threads. Queue to the owner once, unless it merged meanwhile.
+		void RequestMerge() noexcept
+		{
+			sint32 s = shared.load(std::memory_order_relaxed);
+			while ((s & (Merged | Queued)) == 0)
+			{
+				if (shared.compare_exchange_weak(s, s | Queued, std::memory_order_relaxed))
+				{
+					owner->Push(this);
+					return;
+				}
+			}
+		}
+
+	private:
+		BiasedReferenceQueue* const owner = &BiasedReferenceQueue::Current();
+		BiasedReferenceCountBase* nextQueued = nullptr;
+		uint32 biased = 1;
+		std::atomic<sint32> shared = 0;
+	};
+
+	inline BiasedReferenceCountBase::~BiasedReferenceCountBase() noexcept
+	{
+#ifdef MemoryDebug
+		Count() -= 1;
+#endif // MemoryDebug
+	}
+
+	inline void BiasedReferenceQueue::Push(BiasedReferenceCountBase* object) noexcept
+	{
+		BiasedReferenceCountBase* head = pending.load(std::memory_order_relaxed);
+		do
+		{
+			object->nextQueued = head;
+		} while (!pending.compare_exchange_weak(head, object, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	inline void BiasedReferenceQueue::MergePending() noexcept
+	{
+		BiasedReferenceCountBase* object = pending.exchange(nullptr, std::memory_order_acquire);
+		while (object)
+		{
+			BiasedReferenceCountBase* next = object->nextQueued;
+			if (object->MergeBiased(true) == BiasedReferenceCountBase::Merged)
+			{
+				object->OnRelease();
+			}
+			object = next;
+		}
+	}
+
+	namespace ReferenceCountPolicy
+	{
+		// Same memory orders as ReferenceCountBase<true>.
+		struct ThreadSafe
+		{
+			using Counter = std::atomic<sint32>;
+
+			static sint32 Load(Counter const& counter) noexcept
+			{
+				return counter.load(std::memory_order_relaxed);
+			}
+
+			static bool IsUnique(Counter const& counter) noexcept
+			{
+				return counter.load(std::memory_order_acquire) == 1;
+			}
+
+			static void Increase(Counter& counter) noexcept
+			{
+				counter.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			// true when the last reference went.
+			static bool Decrease(Counter& counter) noexcept
+			{
+				return Detail::ReleaseReference(counter);
+			}
+		};
+
+		struct SingleThread
+		{
+			using Counter = sint32;
+
+			static sint32 Load(Counter const& counter) noexcept
+			{
+				return counter;
+			}
+
+			static bool IsUnique(Counter const& counter) noexcept
+			{
+				return counter == 1;
+			}
+
+			static void Increase(Counter& counter) noexcept
+			{
+				counter += 1;
+			}
+
+			static bool Decrease(Counter& counter) noexcept
+			{
+				counter -= 1;
+				return counter == 0;
+			}
+		};
+	}
+
+	/*
+	*	ReferenceCountBase without virtual functions, the object is only the counter and its members and the release path inlines.
+	*	Release calls Derived::OnRelease(), which deletes as Derived by default, so Derived must be the most derived type, best final.
+	*	Derived may declare its own OnRelease() to customize deletion, if not public make ReferenceCounted a friend.
+	*	Works with ReferenceCountPtr<Derived>, not through pointers to a shared base class.
+	*/
+	template <class Derived, class Policy = ReferenceCountPolicy::ThreadSafe>
+	struct ReferenceCounted
+	{
+#ifdef MemoryDebug
+	public:
+		static sint32& Count() noexcept
+		{
+			static sint32 c = 0;
+			return c;
+		}
+
+		ReferenceCounted() noexcept
+		{
+			Count() += 1;
+		}
+
+#endif // MemoryDebug
+
+	public:
+#ifndef MemoryDebug
+		ReferenceCounted() noexcept = default;
+#endif // !MemoryDebug
+
+		ReferenceCounted(ReferenceCounted const& other) noexcept
+		{
+		}
+
+		ReferenceCounted(ReferenceCounted&& other) noexcept
+		{
+		}
+
+		ReferenceCounted& operator=(ReferenceCounted const& other) noexcept
+		{
+			return *this;
+		}
+
+		ReferenceCounted& operator=(ReferenceCounted&& other) noexcept
+		{
+			return *this;
+		}
+
+		bool IsUniqueReference() const noexcept
+		{
+			return Policy::IsUnique(counter);
+		}
+
+		sint32 GetReferenceCount() const noexcept
+		{
+			return Policy::Load(counter);
+		}
+
+		void IncreaseReference() noexcept
+		{
+			Policy::Increase(counter);
+		}
+
+		void DecreaseReference() noexcept
+		{
+			if (Policy::Decrease(counter))
+			{
+				static_cast<Derived*>(this)->OnRelease();
+			}
+		}
+
+	protected:
+		// not virtual, objects are never deleted through ReferenceCounted.
+		~ReferenceCounted() noexcept
+		{
+#ifdef MemoryDebug
+			Count() -= 1;
+#endif // MemoryDebug
+		}
+
+		void OnRelease() noexcept
+		{
+			delete static_cast<Derived*>(this);
+		}
+
+	private:
+		typename Policy::Counter counter = 1;
+	};
+
+	namespace Detail
+	{
+		// An object with one sint32 member, 8 bytes when ReferenceCounted, 16 with the virtual base on 64 bit.
+		struct ReferenceCountedSize final : ReferenceCounted<ReferenceCountedSize>
+		{
+			sint32 value;
+		};
+
+		struct ReferenceCountBaseSize final : ReferenceCountBase<true>
+		{
+			sint32 value;
+		};
+
+		static_assert(sizeof(ReferenceCountedSize) == 2 * sizeof(sint32), "ReferenceCounted holds nothing but the counter.");
+		static_assert(sizeof(ReferenceCountBaseSize) == sizeof(void*) + 2 * sizeof(sint32), "ReferenceCountBase<true> holds the virtual table pointer and the counter.");
+	}
+
 	namespace Ownership
 	{
 		constexpr struct AcquireT
@@ -490,11 +903,17 @@ namespace X
 	}
 
 	template <class T, class... Args>
-	ReferenceCountPtr<T> CreatePtr(Args... args)
+	ReferenceCountPtr<T> CreatePtr(Args&&... args)
 	{
 		return ReferenceCountPtr<T>(new T(std::forward<Args>(args)...), Ownership::Transfer);
 	}
 
 	template <class T>
 	using Ptr = ReferenceCountPtr<T>;
+
+	// only the pointer, the counter does not know where it is held.
+	template <class T>
+	struct IsTriviallyRelocatable<ReferenceCountPtr<T>> : std::true_type
+	{
+	};
 }
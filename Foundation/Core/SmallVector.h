@@ -0,0 +1,366 @@
+#pragma once
+#include "BasicType.h"
+#include "CompressedPair.h"
+#include "ScopeGuard.h"
+#include "Utility.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace X
+{
+	/*
+	*	Vector with inline storage for N elements, the heap is only used beyond N.
+	*	The allocator shares storage with the data pointer through CompressedPair, so a stateless one costs nothing.
+	*	Growth moves trivially relocatable elements with memcpy, see IsTriviallyRelocatable.
+	*	Any growth invalidates pointers, moving an inline vector moves its elements one by one.
+	*/
+	template <class T, uint32 N, class Alloc = std::allocator<T>>
+	class SmallVector
+	{
+		using Traits = std::allocator_traits<Alloc>;
+		static_assert(std::is_same_v<typename Traits::value_type, T>, "Alloc must allocate T.");
+
+	public:
+		using value_type = T;
+		using allocator_type = Alloc;
+		using iterator = T*;
+		using const_iterator = T const*;
+
+		static constexpr uint32 InlineCapacity = N;
+
+	public:
+		SmallVector() noexcept(std::is_nothrow_default_constructible_v<Alloc>) : storage(Alloc(), InlineData())
+		{
+		}
+
+		explicit SmallVector(Alloc const& alloc) noexcept : storage(alloc, InlineData())
+		{
+		}
+
+		explicit SmallVector(uint32 count, Alloc const& alloc = Alloc()) : SmallVector(alloc)
+		{
+			Resize(count);
+		}
+
+		SmallVector(uint32 count, T const& value, Alloc const& alloc = Alloc()) : SmallVector(alloc)
+		{
+			Resize(count, value);
+		}
+
+		SmallVector(std::initializer_list<T> values, Alloc const& alloc = Alloc()) : SmallVector(alloc)
+		{
+			Append(values.begin(), values.end());
+		}
+
+		SmallVector(SmallVector const& other) : SmallVector(Traits::select_on_container_copy_construction(other.GetAllocator()))
+		{
+			Append(other.begin(), other.end());
+		}
+
+		SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) : SmallVector(std::move(other.GetAllocator()))
+		{
+			MoveFrom(other, true);
+		}
+
+		~SmallVector() noexcept
+		{
+			Clear();
+			ReleaseHeap();
+		}
+
+		SmallVector& operator=(SmallVector const& other)
+		{
+			if (this != &other)
+			{
+				Clear();
+				Append(other.begin(), other.end());
+			}
+			return *this;
+		}
+
+		SmallVector& operator=(SmallVector&& other) noexcept((Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value) && std::is_nothrow_move_constructible_v<T>)
+		{
+			if (this != &other)
+			{
+				Clear();
+				if constexpr (Traits::propagate_on_container_move_assignment::value)
+				{
+					if (!other.IsInline())
+					{
+						// the new allocator must free the stolen buffer, so let go of ours first.
+						ReleaseHeap();
+						GetAllocator() = std::move(other.GetAllocator());
+					}
+				}
+				MoveFrom(other, Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value || GetAllocator() == other.GetAllocator());
+			}
+			return *this;
+		}
+
+		Alloc& GetAllocator() noexcept { return storage.E0(); }
+		Alloc const& GetAllocator() const noexcept { return storage.E0(); }
+
+		uint32 Size() const noexcept { return size; }
+		uint32 Capacity() const noexcept { return capacity; }
+		bool Empty() const noexcept { return size == 0; }
+		// true while the elements live in the inline buffer.
+		bool IsInline() const noexcept { return Data() == InlineData(); }
+
+		T* Data() noexcept { return storage.E1(); }
+		T const* Data() const noexcept { return storage.E1(); }
+
+		T& operator[](uint32 index) noexcept { assert(index < size); return Data()[index]; }
+		T const& operator[](uint32 index) const noexcept { assert(index < size); return Data()[index]; }
+
+		T& Front() noexcept { assert(size > 0); return Data()[0]; }
+		T const& Front() const noexcept { assert(size > 0); return Data()[0]; }
+		T& Back() noexcept { assert(size > 0); return Data()[size - 1]; }
+		T const& Back() const noexcept { assert(size > 0); return Data()[size - 1]; }
+
+		T* begin() noexcept { return Data(); }
+		T* end() noexcept { return Data() + size; }
+		T const* begin() const noexcept { return Data(); }
+		T const* end() const noexcept { return Data() + size; }
+
+		void PushBack(T const& value)
+		{
+			EmplaceBack(value);
+		}
+
+		void PushBack(T&& value)
+		{
+			EmplaceBack(std::move(value));
+		}
+
+		// args may refer to elements of this vector.
+		template <class... Args>
+		T& EmplaceBack(Args&&... args)
+		{
+			if (size == capacity)
+			{
+				uint32 const newCapacity = GrowCapacity(size + 1);
+				T* newData = Traits::allocate(GetAllocator(), newCapacity);
+				auto guard = CreateScopeGuard([this, newData, newCapacity]() { Traits::deallocate(GetAllocator(), newData, newCapacity); });
+				// construct first, args may refer to the old buffer.
+				Traits::construct(GetAllocator(), newData + size, std::forward<Args>(args)...);
+				auto destroyGuard = CreateScopeGuard([this, newData]() { Traits::destroy(GetAllocator(), newData + size); });
+				Relocate(Data(), size, newData);
+				destroyGuard.Dismiss();
+				guard.Dismiss();
+				Adopt(newData, newCapacity);
+			}
+			else
+			{
+				Traits::construct(GetAllocator(), Data() + size, std::forward<Args>(args)...);
+			}
+			return Data()[size++];
+		}
+
+		void PopBack() noexcept
+		{
+			assert(size > 0);
+			--size;
+			Traits::destroy(GetAllocator(), Data() + size);
+		}
+
+		template <class Iterator>
+		void Append(Iterator first, Iterator last)
+		{
+			if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>)
+			{
+				Reserve(size + static_cast<uint32>(std::distance(first, last)));
+			}
+			for (; first != last; ++first)
+			{
+				EmplaceBack(*first);
+			}
+		}
+
+		// value is taken by copy, so it may refer to an element.
+		T* Insert(T const* position, T value)
+		{
+			assert(position >= begin() && position <= end());
+			uint32 const index = static_cast<uint32>(position - begin());
+			EmplaceBack(std::move(value));
+			std::rotate(begin() + index, end() - 1, end());
+			return begin() + index;
+		}
+
+		T* Erase(T const* position) noexcept(std::is_nothrow_move_assignable_v<T>)
+		{
+			return Erase(position, position + 1);
+		}
+
+		T* Erase(T const* first, T const* last) noexcept(std::is_nothrow_move_assignable_v<T>)
+		{
+			assert(first >= begin() && first <= last && last <= end());
+			T* const from = begin() + (first - begin());
+			T* const newEnd = std::move(begin() + (last - begin()), end(), from);
+			DestroyFrom(static_cast<uint32>(newEnd - begin()));
+			return from;
+		}
+
+		void Clear() noexcept
+		{
+			DestroyFrom(0);
+		}
+
+		void Reserve(uint32 newCapacity)
+		{
+			if (newCapacity > capacity)
+			{
+				T* newData = Traits::allocate(GetAllocator(), newCapacity);
+				auto guard = CreateScopeGuard([this, newData, newCapacity]() { Traits::deallocate(GetAllocator(), newData, newCapacity); });
+				Relocate(Data(), size, newData);
+				guard.Dismiss();
+				Adopt(newData, newCapacity);
+			}
+		}
+
+		// value initialized, so zeroed for trivial T.
+		void Resize(uint32 newSize)
+		{
+			ResizeWith(newSize, [this](T* p) { Traits::construct(GetAllocator(), p); });
+		}
+
+		void Resize(uint32 newSize, T const& value)
+		{
+			if (newSize > capacity && &value >= begin() && &value < end())
+			{
+				T const copy = value;
+				Resize(newSize, copy);
+				return;
+			}
+			ResizeWith(newSize, [this, &value](T* p) { Traits::construct(GetAllocator(), p, value); });
+		}
+
+	private:
+		T* InlineData() noexcept { return reinterpret_cast<T*>(buffer); }
+		T const* InlineData() const noexcept { return reinterpret_cast<T const*>(buffer); }
+
+		uint32 GrowCapacity(uint32 required) const noexcept
+		{
+			uint32 const doubled = capacity * 2;
+			return doubled > required ? doubled : required;
+		}
+
+		template <class Construct>
+		void ResizeWith(uint32 newSize, Construct&& construct)
+		{
+			if (newSize <= size)
+			{
+				DestroyFrom(newSize);
+				return;
+			}
+			Reserve(newSize);
+			for (; size < newSize; ++size)
+			{
+				construct(Data() + size);
+			}
+		}
+
+		void DestroyFrom(uint32 index) noexcept
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				for (uint32 i = index; i < size; ++i)
+				{
+					Traits::destroy(GetAllocator(), Data() + i);
+				}
+			}
+			size = index;
+		}
+
+		// Move count elements to uninitialized to and destroy the originals, on a throw to is left empty and from untouched.
+		void Relocate(T* from, uint32 count, T* to)
+		{
+			if constexpr (IsTriviallyRelocatable<T>::value)
+			{
+				if (count > 0)
+				{
+					std::memcpy(static_cast<void*>(to), static_cast<void const*>(from), sizeof(T) * count);
+				}
+			}
+			else
+			{
+				uint32 built = 0;
+				try
+				{
+					for (; built < count; ++built)
+					{
+						Traits::construct(GetAllocator(), to + built, std::move_if_noexcept(from[built]));
+					}
+				}
+				catch (...)
+				{
+					for (uint32 i = 0; i < built; ++i)
+					{
+						Traits::destroy(GetAllocator(), to + i);
+					}
+					throw;
+				}
+				for (uint32 i = 0; i < count; ++i)
+				{
+					Traits::destroy(GetAllocator(), from + i);
+				}
+			}
+		}
+
+		// Switch to the relocated heap buffer, freeing the previous one.
+		void Adopt(T* newData, uint32 newCapacity) noexcept
+		{
+			ReleaseHeap();
+			storage.E1() = newData;
+			capacity = newCapacity;
+		}
+
+		void ReleaseHeap() noexcept
+		{
+			if (!IsInline())
+			{
+				Traits::deallocate(GetAllocator(), Data(), capacity);
+				storage.E1() = InlineData();
+				capacity = N;
+			}
+		}
+
+		// this is empty. Steals a heap buffer if the allocator of this can free it, otherwise moves the elements, other is left empty.
+		// Not noexcept, moving into an allocator that can not steal may have to allocate.
+		// The move constructor always steals, and the noexcept move assignment can always steal, so they only move elements into the inline buffer.
+		void MoveFrom(SmallVector& other, bool canSteal)
+		{
+			if (!other.IsInline() && canSteal)
+			{
+				ReleaseHeap();
+				storage.E1() = other.Data();
+				capacity = other.capacity;
+				size = other.size;
+				other.storage.E1() = other.InlineData();
+				other.capacity = N;
+				other.size = 0;
+				return;
+			}
+			Reserve(other.size);
+			for (T& value : other)
+			{
+				Traits::construct(GetAllocator(), Data() + size, std::move(value));
+				++size;
+			}
+			other.Clear();
+		}
+
+	private:
+		// allocator and data, which points to buffer while inline.
+		CompressedPair<Alloc, T*> storage;
+		uint32 size = 0;
+		uint32 capacity = N;
+		alignas(T) unsigned char buffer[N > 0 ? sizeof(T) * N : 1];
+	};
+}
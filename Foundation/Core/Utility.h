@@ -1,5 +1,13 @@
 #pragma once
 #include "BasicType.h"
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__cpp_lib_is_constant_evaluated) || (defined(__clang__) && __clang_major__ >= 9) || (!defined(__clang__) && ((defined(_MSC_VER) && _MSC_VER >= 1925) || (defined(__GNUC__) && __GNUC__ >= 9)))
+#define X_HAS_CONSTANT_EVALUATED
+#endif
 
 namespace X
 {
@@ -9,5 +17,72 @@ namespace X
 		return N;
 	}
 
-}
+	/*
+	*	True if evaluated in a constant expression. Used to keep constexpr paths scalar while runtime uses intrinsics.
+	*	Compilers without the builtin always report true, so they always take the constexpr path,
+	*	X_HAS_CONSTANT_EVALUATED is defined when the builtin is available and SIMD.h refuses to build without it.
+	*/
+	constexpr bool IsConstantEvaluated() noexcept
+	{
+#if defined(X_HAS_CONSTANT_EVALUATED)
+#if defined(__cpp_lib_is_constant_evaluated)
+		return std::is_constant_evaluated();
+#else
+		return __builtin_is_constant_evaluated();
+#endif
+#else
+		return true;
+#endif
+	}
 
+	/*
+	*	True if moving a T to new memory and ending the old object's lifetime is the same as copying its bytes.
+	*	Containers use it to grow with memcpy, specialize it for types holding only such members, e.g. intrusive pointers.
+	*/
+	template <class T>
+	struct IsTriviallyRelocatable : std::is_trivially_copyable<T>
+	{
+	};
+
+	// Index of the lowest set bit, v must not be 0.
+	inline uint32 CountTrailingZeros(uint32 v) noexcept
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, v);
+		return static_cast<uint32>(index);
+#else
+		return static_cast<uint32>(__builtin_ctz(v));
+#endif
+	}
+
+	// Index of the lowest set bit, v must not be 0.
+	inline uint32 CountTrailingZeros(uint64 v) noexcept
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, v);
+		return static_cast<uint32>(index);
+#elif defined(_MSC_VER)
+		uint32 const low = static_cast<uint32>(v);
+		return low != 0 ? CountTrailingZeros(low) : 32 + CountTrailingZeros(static_cast<uint32>(v >> 32));
+#else
+		return static_cast<uint32>(__builtin_ctzll(v));
+#endif
+	}
+
+	inline uint32 PopCount(uint64 v) noexcept
+	{
+#if defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+		return static_cast<uint32>(__popcnt64(v));
+#elif defined(_MSC_VER)
+		// popcnt is not guaranteed below AVX.
+		v = v - ((v >> 1) & 0x5555555555555555ull);
+		v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+		v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return static_cast<uint32>((v * 0x0101010101010101ull) >> 56);
+#else
+		return static_cast<uint32>(__builtin_popcountll(v));
+#endif
+	}
+}
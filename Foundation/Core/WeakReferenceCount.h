@@ -0,0 +1,366 @@
+#pragma once
+#include "BasicType.h"
+#include "ReferenceCount.h"
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace X
+{
+	/*
+	*	Side allocated counters of an object once weak references exist, outlives the object until the last weak reference goes.
+	*	weak counts the weak references plus one for all strong references together.
+	*/
+	struct WeakReferenceControl
+	{
+		std::atomic<sint32> strong;
+		std::atomic<sint32> weak;
+
+		// Increase strong only if the object is still alive.
+		bool TryIncreaseReference() noexcept
+		{
+			sint32 c = strong.load(std::memory_order_relaxed);
+			while (c != 0)
+			{
+				if (strong.compare_exchange_weak(c, c + 1, std::memory_order_relaxed))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void IncreaseWeakReference() noexcept
+		{
+			weak.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void DecreaseWeakReference() noexcept
+		{
+			if (weak.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				delete this;
+			}
+		}
+	};
+
+	/*
+	*	Thread safe reference count base that also supports WeakReferenceCountPtr, derive from it instead of ReferenceCountBase<true>.
+	*	The strong count stays inline until the first weak reference is taken, then moves to a WeakReferenceControl,
+	*	so objects never weakly referenced pay no allocation. The inline word is pointer sized, tagged with the low bit when it holds the control.
+	*	override OnRelease to customize deletion, same as ReferenceCountBase.
+	*/
+	struct WeakReferenceCountBase
+	{
+#ifdef MemoryDebug
+	public:
+		static sint32& Count() noexcept
+		{
+			static sint32 c = 0;
+			return c;
+		}
+
+		WeakReferenceCountBase() noexcept
+		{
+			Count() += 1;
+		}
+
+#endif // MemoryDebug
+
+	public:
+#ifndef MemoryDebug
+		WeakReferenceCountBase() noexcept = default;
+#endif // !MemoryDebug
+
+		WeakReferenceCountBase(WeakReferenceCountBase const& other) noexcept
+		{
+		}
+
+		WeakReferenceCountBase(WeakReferenceCountBase&& other) noexcept
+		{
+		}
+
+		WeakReferenceCountBase& operator=(WeakReferenceCountBase const& other) noexcept
+		{
+			return *this;
+		}
+
+		WeakReferenceCountBase& operator=(WeakReferenceCountBase&& other) noexcept
+		{
+			return *this;
+		}
+
+		bool IsUniqueReference() const noexcept
+		{
+			return GetReferenceCount() == 1;
+		}
+
+		sint32 GetReferenceCount() const noexcept
+		{
+			std::uintptr_t const s = state.load(std::memory_order_acquire);
+			return IsControl(s) ? ToControl(s)->strong.load(std::memory_order_acquire) : static_cast<sint32>(s >> 1);
+		}
+
+		void IncreaseReference() noexcept
+		{
+			// acquire to see the control initialized once it is installed.
+			std::uintptr_t s = state.load(std::memory_order_acquire);
+			while (!IsControl(s))
+			{
+				if (state.compare_exchange_weak(s, s + InlineOne, std::memory_order_acquire))
+				{
+					return;
+				}
+			}
+			ToControl(s)->strong.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void DecreaseReference() noexcept
+		{
+			std::uintptr_t s = state.load(std::memory_order_acquire);
+			while (!IsControl(s))
+			{
+				if (state.compare_exchange_weak(s, s - InlineOne, std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					if (s == InlineOne)
+					{
+						OnRelease();
+					}
+					return;
+				}
+			}
+
+			WeakReferenceControl* control = ToControl(s);
+			if (Detail::ReleaseReference(control->strong))
+			{
+				OnRelease();
+				control->DecreaseWeakReference();
+			}
+		}
+
+		/*
+		*	Control with one more weak reference, created on first call. Caller must hold a strong reference.
+		*/
+		WeakReferenceControl* AcquireWeakReference()
+		{
+			std::uintptr_t s = state.load(std::memory_order_acquire);
+			WeakReferenceControl* created = nullptr;
+			while (!IsControl(s))
+			{
+				if (!created)
+				{
+					created = new WeakReferenceControl();
+				}
+				// the caller's weak reference and the one held by strong references.
+				created->strong.store(static_cast<sint32>(s >> 1), std::memory_order_relaxed);
+				created->weak.store(2, std::memory_order_relaxed);
+				if (state.compare_exchange_weak(s, reinterpret_cast<std::uintptr_t>(created) | ControlTag, std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					return created;
+				}
+			}
+			// another thread installed the control first.
+			delete created;
+			WeakReferenceControl* control = ToControl(s);
+			control->IncreaseWeakReference();
+			return control;
+		}
+
+		virtual ~WeakReferenceCountBase() noexcept = 0;
+
+	protected:
+		virtual void OnRelease() noexcept
+		{
+			delete this;
+		}
+
+	private:
+		static constexpr std::uintptr_t ControlTag = 1;
+		static constexpr std::uintptr_t InlineOne = 2;
+
+		static bool IsControl(std::uintptr_t s) noexcept
+		{
+			return (s & ControlTag) != 0;
+		}
+
+		static WeakReferenceControl* ToControl(std::uintptr_t s) noexcept
+		{
+			return reinterpret_cast<WeakReferenceControl*>(s & ~ControlTag);
+		}
+
+	private:
+		// count << 1 inline, or WeakReferenceControl* | ControlTag.
+		std::atomic<std::uintptr_t> state = InlineOne;
+	};
+
+	inline WeakReferenceCountBase::~WeakReferenceCountBase() noexcept
+	{
+#ifdef MemoryDebug
+		Count() -= 1;
+#endif // MemoryDebug
+	}
+
+	/*
+	*	Non owning reference to a WeakReferenceCountBase object, Lock() for a strong reference while the object is alive.
+	*/
+	template <class T>
+	class WeakReferenceCountPtr
+	{
+	public:
+		template <class Y>
+		friend class WeakReferenceCountPtr;
+	public:
+		~WeakReferenceCountPtr() noexcept
+		{
+			Reset();
+		}
+
+		constexpr WeakReferenceCountPtr() = default;
+
+		explicit constexpr WeakReferenceCountPtr(nullptr_t)
+		{
+		}
+
+		template <class Y, class = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+		WeakReferenceCountPtr(ReferenceCountPtr<Y> const& other)
+		{
+			static_assert(std::is_base_of<WeakReferenceCountBase, Y>::value, "WeakReferenceCountPtr needs objects derived from WeakReferenceCountBase.");
+			if (other)
+			{
+				ptr = other.Get();
+				control = other->AcquireWeakReference();
+			}
+		}
+
+		WeakReferenceCountPtr(WeakReferenceCountPtr const& other) noexcept
+		{
+			CopyIn(other);
+		}
+
+		WeakReferenceCountPtr(WeakReferenceCountPtr&& other) noexcept
+		{
+			MoveIn(std::move(other));
+		}
+
+		template <class Y, class = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+		WeakReferenceCountPtr(WeakReferenceCountPtr<Y> const& other) noexcept
+		{
+			CopyIn(other);
+		}
+
+		template <class Y, class = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+		WeakReferenceCountPtr(WeakReferenceCountPtr<Y>&& other) noexcept
+		{
+			MoveIn(std::move(other));
+		}
+
+		WeakReferenceCountPtr& operator=(nullptr_t) noexcept
+		{
+			Reset();
+			return *this;
+		}
+
+		template <class Y, class = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+		WeakReferenceCountPtr& operator=(ReferenceCountPtr<Y> const& other)
+		{
+			WeakReferenceCountPtr weak(other);
+			MoveIn(std::move(weak));
+			return *this;
+		}
+
+		WeakReferenceCountPtr& operator=(WeakReferenceCountPtr const& other) noexcept
+		{
+			CopyIn(other);
+			return *this;
+		}
+
+		WeakReferenceCountPtr& operator=(WeakReferenceCountPtr&& other) noexcept
+		{
+			MoveIn(std::move(other));
+			return *this;
+		}
+
+		template <class Y, class = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+		WeakReferenceCountPtr& operator=(WeakReferenceCountPtr<Y> const& other) noexcept
+		{
+			CopyIn(other);
+			return *this;
+		}
+
+		template <class Y, class = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+		WeakReferenceCountPtr& operator=(WeakReferenceCountPtr<Y>&& other) noexcept
+		{
+			MoveIn(std::move(other));
+			return *this;
+		}
+
+		/*
+		*	Strong reference if the object is still alive, otherwise null. Lock free.
+		*/
+		ReferenceCountPtr<T> Lock() const noexcept
+		{
+			if (control && control->TryIncreaseReference())
+			{
+				return ReferenceCountPtr<T>(ptr, Ownership::Transfer);
+			}
+			return ReferenceCountPtr<T>();
+		}
+
+		// Only a hint when other threads hold strong references.
+		bool Expired() const noexcept
+		{
+			return !control || control->strong.load(std::memory_order_acquire) == 0;
+		}
+
+		void Reset() noexcept
+		{
+			if (control)
+			{
+				control->DecreaseWeakReference();
+				control = nullptr;
+				ptr = nullptr;
+			}
+		}
+
+	private:
+		template <class Y>
+		void CopyIn(WeakReferenceCountPtr<Y> const& other) noexcept
+		{
+			if (other.control)
+			{
+				other.control->IncreaseWeakReference();
+			}
+			if (control)
+			{
+				control->DecreaseWeakReference();
+			}
+			ptr = other.ptr;
+			control = other.control;
+		}
+
+		template <class Y>
+		void MoveIn(WeakReferenceCountPtr<Y>&& other) noexcept
+		{
+			if (static_cast<void*>(this) != static_cast<void*>(&other))
+			{
+				if (control)
+				{
+					control->DecreaseWeakReference();
+				}
+				ptr = other.ptr;
+				control = other.control;
+				other.ptr = nullptr;
+				other.control = nullptr;
+			}
+		}
+
+	private:
+		// dangling once the object is released, only handed out by a successful Lock().
+		T* ptr = nullptr;
+		WeakReferenceControl* control = nullptr;
+	};
+
+	template <class T>
+	using WeakPtr = WeakReferenceCountPtr<T>;
+}
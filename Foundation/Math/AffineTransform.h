@@ -0,0 +1,365 @@
+#pragma once
+
+#include "Core/BasicType.h"
+#include "Math/BasicMath.h"
+#include "Math/Vector.h"
+#include "Math/Matrix.h"
+#include <cassert>
+#include <cmath>
+
+
+namespace X
+{
+	/*
+	*	Affine transform, a 4x4 matrix with implied last row (0, 0, 0, 1).
+	*	Column major storage like Matrix, 3 rows x 4 columns, the last column is translation.
+	*/
+	template <class T>
+	class AffineTransform
+	{
+
+	public:
+		static constexpr uint32 R = 3;
+		static constexpr uint32 C = 4;
+		static constexpr uint32 Count = R * C;
+
+		static AffineTransform const Identity;
+
+		union
+		{
+			struct
+			{
+				T	_00, _10, _20,
+					_01, _11, _21,
+					_02, _12, _22,
+					_03, _13, _23;
+			};
+			Vector<Vector<T, R>, C> v;
+		};
+
+
+		constexpr AffineTransform() noexcept = default;
+		/*
+		*	Create a uniform scaling transform, fill principal diagonal with r.
+		*/
+		explicit constexpr AffineTransform(T const& r) noexcept : v({ r, 0, 0 }, { 0, r, 0 }, { 0, 0, r }, { 0, 0, 0 }) {}
+
+		/*
+		*	parameters subscript: row, column
+		*/
+		constexpr AffineTransform(
+			T const& m00, T const& m10, T const& m20,
+			T const& m01, T const& m11, T const& m21,
+			T const& m02, T const& m12, T const& m22,
+			T const& m03, T const& m13, T const& m23) noexcept
+			: v({ m00, m10, m20 }, { m01, m11, m21 }, { m02, m12, m22 }, { m03, m13, m23 }) {}
+
+		constexpr AffineTransform(Vector<T, R> const& c0, Vector<T, R> const& c1, Vector<T, R> const& c2, Vector<T, R> const& translation) noexcept : v(c0, c1, c2, translation) {}
+
+		constexpr AffineTransform(Matrix<T, 3, 3> const& linear, Vector<T, R> const& translation) noexcept : v(linear.v[0], linear.v[1], linear.v[2], translation) {}
+
+		/*
+		*	Drop the last row of matrix, which must be (0, 0, 0, 1).
+		*/
+		explicit constexpr AffineTransform(Matrix<T, 4, 4> const& m) noexcept
+			: v({ m.v[0][0], m.v[0][1], m.v[0][2] }, { m.v[1][0], m.v[1][1], m.v[1][2] }, { m.v[2][0], m.v[2][1], m.v[2][2] }, { m.v[3][0], m.v[3][1], m.v[3][2] })
+		{
+			assert(m.v[0][3] == T(0) && m.v[1][3] == T(0) && m.v[2][3] == T(0) && m.v[3][3] == T(1));
+		}
+
+		template <class U>
+		constexpr explicit AffineTransform(AffineTransform<U> const& r) noexcept : v(r.v) {}
+
+		constexpr T const& operator[](Index2UI index) const noexcept { return v[index.Y()][index.X()]; }
+		constexpr T& operator[](Index2UI index) noexcept { return v[index.Y()][index.X()]; }
+
+		constexpr Vector<T, R> const& operator[](uint32 index) const { return v[index]; }
+		constexpr Vector<T, R>& operator[](uint32 index) { return v[index]; }
+
+		constexpr Vector<T, R> const& Column(uint32 index) const noexcept { return v[index]; }
+
+		constexpr Matrix<T, 3, 3> Linear() const noexcept { return Matrix<T, 3, 3>(v[0], v[1], v[2]); }
+		constexpr Vector<T, R> const& Translation() const noexcept { return v[3]; }
+
+		constexpr Matrix<T, 4, 4> ToMatrix() const noexcept
+		{
+			return Matrix<T, 4, 4>(
+				v[0][0], v[0][1], v[0][2], T(0),
+				v[1][0], v[1][1], v[1][2], T(0),
+				v[2][0], v[2][1], v[2][2], T(0),
+				v[3][0], v[3][1], v[3][2], T(1));
+		}
+
+		/*
+		*	w of point is 1, translation applied.
+		*/
+		constexpr Vector<T, 3> TransformPoint(Vector<T, 3> const& p) const noexcept
+		{
+			return Vector<T, 3>(
+				v[0][0] * p[0] + v[1][0] * p[1] + v[2][0] * p[2] + v[3][0],
+				v[0][1] * p[0] + v[1][1] * p[1] + v[2][1] * p[2] + v[3][1],
+				v[0][2] * p[0] + v[1][2] * p[1] + v[2][2] * p[2] + v[3][2]);
+		}
+
+		/*
+		*	w of direction is 0, translation ignored.
+		*/
+		constexpr Vector<T, 3> TransformDirection(Vector<T, 3> const& d) const noexcept
+		{
+			return Vector<T, 3>(
+				v[0][0] * d[0] + v[1][0] * d[1] + v[2][0] * d[2],
+				v[0][1] * d[0] + v[1][1] * d[1] + v[2][1] * d[2],
+				v[0][2] * d[0] + v[1][2] * d[1] + v[2][2] * d[2]);
+		}
+
+		constexpr AffineTransform Inversed() const noexcept
+		{
+			// rows of the adjugate of the linear part
+			Vector<T, 3> const r0 = Cross(v[1], v[2]), r1 = Cross(v[2], v[0]), r2 = Cross(v[0], v[1]);
+
+			T determinant = Dot(v[0], r0);
+
+			// non-invertible
+			if (BasicMath::CEqual<T>(determinant, 0))
+			{
+				assert(false);
+				return AffineTransform(T(1));
+			}
+
+			T inverseDeterminant = T(1) / determinant;
+
+			return AffineTransform(
+				r0[0] * inverseDeterminant, r1[0] * inverseDeterminant, r2[0] * inverseDeterminant,
+				r0[1] * inverseDeterminant, r1[1] * inverseDeterminant, r2[1] * inverseDeterminant,
+				r0[2] * inverseDeterminant, r1[2] * inverseDeterminant, r2[2] * inverseDeterminant,
+				-Dot(r0, v[3]) * inverseDeterminant, -Dot(r1, v[3]) * inverseDeterminant, -Dot(r2, v[3]) * inverseDeterminant);
+		}
+
+		/*
+		*	Inverse of a rotation and translation only transform, the linear part must be orthonormal.
+		*/
+		constexpr AffineTransform RigidInversed() const noexcept
+		{
+			return AffineTransform(
+				v[0][0], v[1][0], v[2][0],
+				v[0][1], v[1][1], v[2][1],
+				v[0][2], v[1][2], v[2][2],
+				-Dot(v[0], v[3]), -Dot(v[1], v[3]), -Dot(v[2], v[3]));
+		}
+
+		constexpr T Determinant() const noexcept
+		{
+			return Dot(v[0], Cross(v[1], v[2]));
+		}
+
+		T const* Data() const noexcept
+		{
+			return v.Data()->Data();
+		}
+
+		constexpr AffineTransform(Vector<Vector<T, R>, C> const& columns) noexcept : v(columns) {}
+	};
+
+	template <class T>
+	AffineTransform<T> const AffineTransform<T>::Identity = AffineTransform(T(1));
+
+	/*
+	*	Same as l.ToMatrix() * r.ToMatrix(), without the constant last row.
+	*/
+	template<class T>
+	constexpr AffineTransform<T> operator*(AffineTransform<T> const& l, AffineTransform<T> const& r) noexcept
+	{
+		return AffineTransform<T>(
+			r[0][0] * l[0][0] + r[0][1] * l[1][0] + r[0][2] * l[2][0],
+			r[0][0] * l[0][1] + r[0][1] * l[1][1] + r[0][2] * l[2][1],
+			r[0][0] * l[0][2] + r[0][1] * l[1][2] + r[0][2] * l[2][2],
+			r[1][0] * l[0][0] + r[1][1] * l[1][0] + r[1][2] * l[2][0],
+			r[1][0] * l[0][1] + r[1][1] * l[1][1] + r[1][2] * l[2][1],
+			r[1][0] * l[0][2] + r[1][1] * l[1][2] + r[1][2] * l[2][2],
+			r[2][0] * l[0][0] + r[2][1] * l[1][0] + r[2][2] * l[2][0],
+			r[2][0] * l[0][1] + r[2][1] * l[1][1] + r[2][2] * l[2][1],
+			r[2][0] * l[0][2] + r[2][1] * l[1][2] + r[2][2] * l[2][2],
+			r[3][0] * l[0][0] + r[3][1] * l[1][0] + r[3][2] * l[2][0] + l[3][0],
+			r[3][0] * l[0][1] + r[3][1] * l[1][1] + r[3][2] * l[2][1] + l[3][1],
+			r[3][0] * l[0][2] + r[3][1] * l[1][2] + r[3][2] * l[2][2] + l[3][2]);
+	}
+
+	template<class T>
+	constexpr bool operator==(AffineTransform<T> const& l, AffineTransform<T> const& r) noexcept
+	{
+		return l.v == r.v;
+	}
+	template<class T>
+	constexpr bool operator!=(AffineTransform<T> const& l, AffineTransform<T> const& r) noexcept
+	{
+		return l.v != r.v;
+	}
+
+
+	/*
+	*	Affine forms of the Math matrix builders, same elements without the constant last row.
+	*	The rotation builders return a zero transform for zero length input, like their matrix versions.
+	*/
+	template <class T>
+	constexpr AffineTransform<T> TranslationAffine(T const& x, T const& y, T const& z) noexcept
+	{
+		return AffineTransform<T>(
+			1, 0, 0,
+			0, 1, 0,
+			0, 0, 1,
+			x, y, z);
+	}
+
+	template <class T>
+	constexpr AffineTransform<T> TranslationAffine(Vector<T, 3> const& v) noexcept
+	{
+		return TranslationAffine(v[0], v[1], v[2]);
+	}
+
+	template <class T>
+	constexpr AffineTransform<T> ScalingAffine(T const& sx, T const& sy, T const& sz) noexcept
+	{
+		return AffineTransform<T>(
+			sx, 0, 0,
+			0, sy, 0,
+			0, 0, sz,
+			0, 0, 0);
+	}
+
+	template <class T>
+	constexpr AffineTransform<T> ScalingAffine(T const& s) noexcept
+	{
+		return ScalingAffine(s, s, s);
+	}
+
+	template <class T>
+	constexpr AffineTransform<T> ScalingAffine(Vector<T, 3> const& s) noexcept
+	{
+		return ScalingAffine(s[0], s[1], s[2]);
+	}
+
+	template <class T>
+	AffineTransform<T> RotationAffineX(T const& angleX) noexcept
+	{
+		T const sx = std::sin(angleX);
+		T const cx = std::cos(angleX);
+		return AffineTransform<T>(
+			1, 0, 0,
+			0, cx, -sx,
+			0, sx, cx,
+			0, 0, 0);
+	}
+
+	template <class T>
+	AffineTransform<T> RotationAffineY(T const& angleY) noexcept
+	{
+		T const sy = std::sin(angleY);
+		T const cy = std::cos(angleY);
+		return AffineTransform<T>(
+			cy, 0, sy,
+			0, 1, 0,
+			-sy, 0, cy,
+			0, 0, 0);
+	}
+
+	template <class T>
+	AffineTransform<T> RotationAffineZ(T const& angleZ) noexcept
+	{
+		T const sz = std::sin(angleZ);
+		T const cz = std::cos(angleZ);
+		return AffineTransform<T>(
+			cz, -sz, 0,
+			sz, cz, 0,
+			0, 0, 1,
+			0, 0, 0);
+	}
+
+	template <class T>
+	AffineTransform<T> RotationAffine(T const& angle, Vector<T, 3> const& axis) noexcept
+	{
+		if (axis.LengthSquared() == 0)
+		{
+			return AffineTransform<T>(T(0));
+		}
+		Vector<T, 3> const u = axis.Normalized();
+		T const sin = std::sin(angle);
+		T const cos = std::cos(angle);
+		T const t = 1 - cos;
+
+		// see 'Mathematics for 3D Game Programming and Computer Graphics, 3rd', 4.3.1
+		return AffineTransform<T>(
+			u[0] * u[0] * t + cos, u[1] * u[0] * t + u[2] * sin, u[2] * u[0] * t - u[1] * sin,
+			u[0] * u[1] * t - u[2] * sin, u[1] * u[1] * t + cos, u[2] * u[1] * t + u[0] * sin,
+			u[0] * u[2] * t + u[1] * sin, u[1] * u[2] * t - u[0] * sin, u[2] * u[2] * t + cos,
+			0, 0, 0);
+	}
+
+	template <class T>
+	AffineTransform<T> RotationAffine(T const& angle, T const& x, T const& y, T const& z) noexcept
+	{
+		return RotationAffine(angle, Vector<T, 3>(x, y, z));
+	}
+
+	template <class T>
+	AffineTransform<T> RotationAffineFromTo(Vector<T, 3> const& from, Vector<T, 3> const& to) noexcept
+	{
+		if (from.LengthSquared() == 0 || to.LengthSquared() == 0)
+		{
+			return AffineTransform<T>(T(0));
+		}
+		Vector<T, 3> const f = from.Normalized();
+		Vector<T, 3> const u = to.Normalized();
+
+		// see 'Real-time Rendering, 3rd', 4.3.2, 'Rotation from One Vector to Another'
+		Vector<T, 3> const v = Cross(f, u);
+		T const e = Dot(f, u);
+		T const h = T(1) / (T(1) + e);
+		return AffineTransform<T>(
+			e + h * v[0] * v[0], h * v[0] * v[1] + v[2], h * v[0] * v[2] - v[1],
+			h * v[0] * v[1] - v[2], e + h * v[1] * v[1], h * v[1] * v[2] + v[0],
+			h * v[0] * v[2] + v[1], h * v[1] * v[2] - v[0], e + h * v[2] * v[2],
+			0, 0, 0);
+	}
+
+	/*
+	*	@to: face to direction in world space.
+	*	@up: up direction in world space as reference.
+	*	@localFront: front direction in local space.
+	*	@localUp: up reference direction in local space.
+	*	@return: transform only contains rotation component.
+	*/
+	template <class T>
+	AffineTransform<T> FaceToAffine(Vector<T, 3> const& to, Vector<T, 3> const& up, Vector<T, 3> const& localFront, Vector<T, 3> const& localUp) noexcept
+	{
+		// orthonormal basis with z along front and y closest to reference, as columns x, y, z.
+		auto basis = [](Vector<T, 3> const& front, Vector<T, 3> const& reference, Matrix<T, 3, 3>& result)
+		{
+			if (front.LengthSquared() == 0 || reference.LengthSquared() == 0)
+			{
+				return false;
+			}
+			Vector<T, 3> const z = front.Normalized();
+			Vector<T, 3> const l = Cross(reference, z);
+			if (l.LengthSquared() == 0)
+			{
+				return false;
+			}
+			Vector<T, 3> const x = l.Normalized();
+			result = Matrix<T, 3, 3>(x, Cross(z, x), z);
+			return true;
+		};
+
+		// M * localX/Y/Z = worldX/Y/Z, so M = world(X,Y,Z) * local(X,Y,Z)^(-1)
+		Matrix<T, 3, 3> world, local;
+		if (!basis(to, up, world) || !basis(localFront, localUp, local))
+		{
+			return AffineTransform<T>(T(0));
+		}
+		return AffineTransform<T>(world * local.Transposed(), Vector<T, 3>(T(0)));
+	}
+
+
+	using AffineF32 = AffineTransform<float32>;
+	using AffineF64 = AffineTransform<float64>;
+
+}
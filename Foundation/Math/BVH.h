@@ -0,0 +1,432 @@
+#pragma once
+#include "Core/BasicType.h"
+#include "Math/Vector.h"
+#include "Math/Geometry.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace X
+{
+	/*
+	*	Bounding volume hierarchy over user primitives, built from one AABB per primitive with the binned surface area heuristic,
+	*	see 'On fast Construction of SAH-based Bounding Volume Hierarchies', Ingo Wald.
+	*	Nodes are flattened depth first, the left child follows its parent and the right child is at parent + offset.
+	*	Primitives are referenced by index only, queries call back for the exact test.
+	*/
+	template <typename T>
+	class BVH
+	{
+	public:
+		// 32 bytes for float32, two nodes per cache line.
+		struct Node
+		{
+			Vector<T, 3> minimum;
+			// leaf: first of count entries in primitive indices, interior: distance to the right child.
+			uint32 offset;
+			Vector<T, 3> maximum;
+			// 0 for interior nodes.
+			uint32 count;
+
+			bool IsLeaf() const noexcept { return count != 0; }
+			AABB<T, 3> Bounds() const noexcept { return AABB<T, 3>(minimum, maximum); }
+		};
+
+		static constexpr uint32 BinCount = 16;
+		static constexpr uint32 MaxLeafSize = 8;
+		// Bound of the tree depth and of the traversal stack, deep subtrees fall back to median splits.
+		static constexpr uint32 MaxDepth = 64;
+		// Ranges smaller than this are never split across threads.
+		static constexpr uint32 MinParallelCount = 4096;
+
+	public:
+		BVH() noexcept = default;
+
+		BVH(AABB<T, 3> const* bounds, uint32 count, uint32 threadCount = 1)
+		{
+			Build(bounds, count, threadCount);
+		}
+
+		/*
+		*	@bounds: count boxes, none of them empty.
+		*	@threadCount: the top levels are split across up to this many threads.
+		*/
+		void Build(AABB<T, 3> const* bounds, uint32 count, uint32 threadCount = 1)
+		{
+			nodes_.clear();
+			indices_.resize(count);
+			if (count == 0)
+			{
+				return;
+			}
+
+			std::vector<Vector<T, 3>> centers(count);
+			for (uint32 i = 0; i < count; ++i)
+			{
+				assert(!bounds[i].Empty());
+				indices_[i] = i;
+				centers[i] = bounds[i].Center();
+			}
+
+			uint32 parallelDepth = 0;
+			while ((1u << parallelDepth) < threadCount)
+			{
+				++parallelDepth;
+			}
+
+			Builder const builder = { bounds, centers.data(), indices_.data() };
+			// every leaf holds a primitive at least, so at most 2 * count - 1 nodes.
+			nodes_.reserve(2 * count - 1);
+			builder.Build(nodes_, 0, count, 0, parallelDepth);
+		}
+
+		/*
+		*	Recompute node bounds after primitives moved, the topology is kept. Cheap, but the tree degrades as primitives move far.
+		*	@bounds: the same primitives in the same order as Build().
+		*/
+		void Refit(AABB<T, 3> const* bounds) noexcept
+		{
+			// children follow their parents, so reverse order visits children first.
+			for (uint32 i = static_cast<uint32>(nodes_.size()); i-- > 0;)
+			{
+				Node& node = nodes_[i];
+				AABB<T, 3> box;
+				if (node.IsLeaf())
+				{
+					for (uint32 j = node.offset; j < node.offset + node.count; ++j)
+					{
+						box.Merge(bounds[indices_[j]]);
+					}
+				}
+				else
+				{
+					box = nodes_[i + 1].Bounds();
+					box.Merge(nodes_[i + node.offset].Bounds());
+				}
+				node.minimum = box.minimum;
+				node.maximum = box.maximum;
+			}
+		}
+
+		bool Empty() const noexcept { return nodes_.empty(); }
+
+		AABB<T, 3> Bounds() const noexcept { return nodes_.empty() ? AABB<T, 3>() : nodes_[0].Bounds(); }
+
+		std::vector<Node> const& GetNodes() const noexcept { return nodes_; }
+		std::vector<uint32> const& GetPrimitiveIndices() const noexcept { return indices_; }
+
+		/*
+		*	Nearest hit along ray in [0, t), children are visited near first.
+		*	@t: in, the maximum distance, out, the distance of the nearest hit.
+		*	@intersect: bool(uint32 primitive, T& t), returns true and shrinks t when primitive is hit closer than t.
+		*	@return: the primitive hit, or std::numeric_limits<uint32>::max() if none.
+		*/
+		template <typename Intersect>
+		uint32 ClosestHit(RayT<T> const& ray, T& t, Intersect&& intersect) const
+		{
+			uint32 closest = std::numeric_limits<uint32>::max();
+			Traverse(ray, t, [&closest, &intersect](uint32 primitive, T& tMax)
+			{
+				if (intersect(primitive, tMax))
+				{
+					closest = primitive;
+				}
+				return false;
+			});
+			return closest;
+		}
+
+		/*
+		*	True as soon as any primitive is hit in [0, t), for occlusion and line of sight, traversal order is unspecified.
+		*	@intersect: same as ClosestHit().
+		*/
+		template <typename Intersect>
+		bool AnyHit(RayT<T> const& ray, T t, Intersect&& intersect) const
+		{
+			return Traverse(ray, t, [&intersect](uint32 primitive, T& tMax)
+			{
+				return intersect(primitive, tMax);
+			});
+		}
+
+		/*
+		*	Calls visit(uint32 primitive) once for every primitive in leaves overlapping box, a superset of the primitives overlapping it.
+		*/
+		template <typename Visit>
+		void Overlap(AABB<T, 3> const& box, Visit&& visit) const
+		{
+			if (nodes_.empty())
+			{
+				return;
+			}
+
+			uint32 stack[MaxDepth];
+			uint32 top = 0;
+			uint32 current = 0;
+			while (true)
+			{
+				Node const& node = nodes_[current];
+				if (box.Overlaps(node.Bounds()))
+				{
+					if (node.IsLeaf())
+					{
+						for (uint32 j = node.offset; j < node.offset + node.count; ++j)
+						{
+							visit(indices_[j]);
+						}
+					}
+					else
+					{
+						stack[top++] = current + node.offset;
+						current = current + 1;
+						continue;
+					}
+				}
+				if (top == 0)
+				{
+					return;
+				}
+				current = stack[--top];
+			}
+		}
+
+	private:
+		// hit(primitive, t) is called for primitives of leaves the ray reaches within t and may shrink t, traversal stops when it returns true.
+		template <typename Hit>
+		bool Traverse(RayT<T> const& ray, T& t, Hit&& hit) const
+		{
+			if (nodes_.empty())
+			{
+				return false;
+			}
+
+			Vector<T, 3> const& origin = ray.GetOrigin();
+			Vector<T, 3> const& d = ray.GetDirection();
+			Vector<T, 3> const inverseDirection(T(1) / d[0], T(1) / d[1], T(1) / d[2]);
+
+			T tNear;
+			if (!nodes_[0].Bounds().Intersects(origin, inverseDirection, T(0), t, tNear))
+			{
+				return false;
+			}
+
+			// far children and their entry distances, skipped when a closer hit is found meanwhile.
+			uint32 stack[MaxDepth];
+			T stackNear[MaxDepth];
+			uint32 top = 0;
+			uint32 current = 0;
+			while (true)
+			{
+				Node const& node = nodes_[current];
+				if (node.IsLeaf())
+				{
+					for (uint32 j = node.offset; j < node.offset + node.count; ++j)
+					{
+						if (hit(indices_[j], t))
+						{
+							return true;
+						}
+					}
+				}
+				else
+				{
+					uint32 first = current + 1, second = current + node.offset;
+					T tFirst, tSecond;
+					bool const hitFirst = nodes_[first].Bounds().Intersects(origin, inverseDirection, T(0), t, tFirst);
+					bool const hitSecond = nodes_[second].Bounds().Intersects(origin, inverseDirection, T(0), t, tSecond);
+					if (hitFirst && hitSecond)
+					{
+						if (tSecond < tFirst)
+						{
+							std::swap(first, second);
+							std::swap(tFirst, tSecond);
+						}
+						assert(top < MaxDepth);
+						stack[top] = second;
+						stackNear[top] = tSecond;
+						++top;
+						current = first;
+						continue;
+					}
+					if (hitFirst || hitSecond)
+					{
+						current = hitFirst ? first : second;
+						continue;
+					}
+				}
+
+				do
+				{
+					if (top == 0)
+					{
+						return false;
+					}
+					--top;
+				} while (t < stackNear[top]);
+				current = stack[top];
+			}
+		}
+
+		struct Builder
+		{
+			AABB<T, 3> const* bounds;
+			Vector<T, 3> const* centers;
+			uint32* indices;
+
+			struct Bin
+			{
+				AABB<T, 3> box;
+				uint32 count = 0;
+			};
+
+			// Appends the subtree of indices [begin, end) to nodes.
+			void Build(std::vector<Node>& nodes, uint32 begin, uint32 end, uint32 depth, uint32 parallelDepth) const
+			{
+				AABB<T, 3> box, centerBox;
+				for (uint32 i = begin; i < end; ++i)
+				{
+					box.Merge(bounds[indices[i]]);
+					centerBox.Merge(centers[indices[i]]);
+				}
+
+				uint32 const self = static_cast<uint32>(nodes.size());
+				nodes.push_back({ box.minimum, begin, box.maximum, end - begin });
+
+				uint32 const middle = Split(box, centerBox, begin, end, depth);
+				if (middle == begin)
+				{
+					return;
+				}
+				nodes[self].count = 0;
+
+				if (parallelDepth > 0 && end - begin >= MinParallelCount)
+				{
+					std::vector<Node> right;
+					right.reserve(end - middle);
+					std::thread thread([this, &right, middle, end, depth, parallelDepth]() { Build(right, middle, end, depth + 1, parallelDepth - 1); });
+					Build(nodes, begin, middle, depth + 1, parallelDepth - 1);
+					thread.join();
+					nodes[self].offset = static_cast<uint32>(nodes.size()) - self;
+					nodes.insert(nodes.end(), right.begin(), right.end());
+				}
+				else
+				{
+					Build(nodes, begin, middle, depth + 1, 0);
+					nodes[self].offset = static_cast<uint32>(nodes.size()) - self;
+					Build(nodes, middle, end, depth + 1, 0);
+				}
+			}
+
+			// Partitions [begin, end) and returns the first index of the right side, begin to make a leaf.
+			uint32 Split(AABB<T, 3> const& box, AABB<T, 3> const& centerBox, uint32 begin, uint32 end, uint32 depth) const
+			{
+				uint32 const count = end - begin;
+				if (count == 1)
+				{
+					return begin;
+				}
+
+				uint32 axis = 0;
+				Vector<T, 3> const extent = centerBox.Size();
+				for (uint32 c = 1; c < 3; ++c)
+				{
+					axis = extent[axis] < extent[c] ? c : axis;
+				}
+
+				// all centers at one point, or too deep for the traversal stack.
+				if (!(extent[axis] > T(0)) || depth + 32 >= MaxDepth)
+				{
+					if (count <= MaxLeafSize)
+					{
+						return begin;
+					}
+					uint32 const middle = begin + count / 2;
+					std::nth_element(indices + begin, indices + middle, indices + end, [this, axis](uint32 l, uint32 r) { return centers[l][axis] < centers[r][axis]; });
+					return middle;
+				}
+
+				// leaf cost is count, a split costs one traversal plus both sides weighted by area.
+				T bestCost = std::numeric_limits<T>::max();
+				uint32 bestAxis = 0, bestBin = 0;
+				for (uint32 c = 0; c < 3; ++c)
+				{
+					if (!(extent[c] > T(0)))
+					{
+						continue;
+					}
+
+					Bin bins[BinCount];
+					T const scale = T(BinCount) / extent[c];
+					for (uint32 i = begin; i < end; ++i)
+					{
+						Bin& bin = bins[BinIndex(centers[indices[i]][c], centerBox.minimum[c], scale)];
+						bin.box.Merge(bounds[indices[i]]);
+						++bin.count;
+					}
+
+					// right side costs of splitting after bin b, swept from the right.
+					T rightCost[BinCount - 1];
+					AABB<T, 3> rightBox;
+					uint32 rightCount = 0;
+					for (uint32 b = BinCount - 1; b > 0; --b)
+					{
+						rightBox.Merge(bins[b].box);
+						rightCount += bins[b].count;
+						rightCost[b - 1] = rightCount == 0 ? T(0) : rightBox.SurfaceArea() * T(rightCount);
+					}
+
+					AABB<T, 3> leftBox;
+					uint32 leftCount = 0;
+					for (uint32 b = 0; b < BinCount - 1; ++b)
+					{
+						leftBox.Merge(bins[b].box);
+						leftCount += bins[b].count;
+						if (leftCount == 0 || leftCount == count)
+						{
+							continue;
+						}
+						T const cost = leftBox.SurfaceArea() * T(leftCount) + rightCost[b];
+						if (cost < bestCost)
+						{
+							bestCost = cost;
+							bestAxis = c;
+							bestBin = b;
+						}
+					}
+				}
+
+				T const area = box.SurfaceArea();
+				bool const splitWorse = !(T(1) + bestCost / area < T(count));
+				if (bestCost == std::numeric_limits<T>::max() || (splitWorse && count <= MaxLeafSize))
+				{
+					return begin;
+				}
+
+				T const scale = T(BinCount) / extent[bestAxis];
+				T const minimum = centerBox.minimum[bestAxis];
+				uint32 const* middle = std::partition(indices + begin, indices + end, [this, bestAxis, bestBin, minimum, scale](uint32 i)
+				{
+					return BinIndex(centers[i][bestAxis], minimum, scale) <= bestBin;
+				});
+				return static_cast<uint32>(middle - indices);
+			}
+
+			static uint32 BinIndex(T const& center, T const& minimum, T const& scale) noexcept
+			{
+				uint32 const bin = static_cast<uint32>((center - minimum) * scale);
+				return bin < BinCount ? bin : BinCount - 1;
+			}
+		};
+
+	private:
+		std::vector<Node> nodes_;
+		std::vector<uint32> indices_;
+	};
+
+	using BVHF32 = BVH<float32>;
+
+	static_assert(sizeof(BVHF32::Node) == 32, "BVH node should be 32 bytes.");
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include "Core/BasicType.h"
+#include "Core/Utility.h"
+#include "Math/SIMD.h"
+#include "Math/Vector.h"
+#include "Math/Geometry.h"
+#include "Math/VectorStream.h"
+#include <cassert>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace X
+{
+	/*
+	*	Batched frustum culling over SoA bounds. Visibility is a bitmask, bit (i % 32) of word (i / 32) is set when object i is at least partially inside.
+	*	A range [begin, end) only writes the words it covers, so ranges starting at multiples of CullWordBits may run concurrently.
+	*/
+
+	constexpr uint32 CullWordBits = 32;
+
+	constexpr uint32 CullWordCount(uint32 count) noexcept { return (count + CullWordBits - 1) / CullWordBits; }
+
+	namespace Detail
+	{
+		template <class T>
+		struct BroadcastFrustum
+		{
+			using P = SIMD::Pack<T>;
+			using Type = typename P::Type;
+
+			Type nx[6], ny[6], nz[6], d[6];
+			bool positive[6][3];
+
+			explicit BroadcastFrustum(FrustumT<T> const& frustum) noexcept
+			{
+				for (uint32 i = 0; i < 6; ++i)
+				{
+					PlaneT<T> const& plane = frustum.GetPlane(i);
+					Vector<T, 3> const& n = plane.GetNormal();
+					nx[i] = P::Set(n[0]);
+					ny[i] = P::Set(n[1]);
+					nz[i] = P::Set(n[2]);
+					d[i] = P::Set(plane.GetDistance());
+					for (uint32 c = 0; c < 3; ++c)
+					{
+						positive[i][c] = !(n[c] < T(0));
+					}
+				}
+			}
+
+			Type Distance(uint32 i, Type x, Type y, Type z) const noexcept
+			{
+				return P::MulAdd(nx[i], x, P::MulAdd(ny[i], y, P::MulAdd(nz[i], z, d[i])));
+			}
+		};
+
+		// Runs test(i) for every register in [begin, end), returning the lanes that are inside, and writes the bits.
+		template <class T, class Test>
+		void Cull(uint32* visibility, uint32 size, uint32 paddedSize, uint32 begin, uint32 end, Test&& test)
+		{
+			using P = SIMD::Pack<T>;
+			static_assert(CullWordBits % P::Width == 0, "Register width must divide the visibility word.");
+			assert(begin % CullWordBits == 0);
+			assert(begin <= end && end <= size);
+
+			for (uint32 word = begin / CullWordBits; word < CullWordCount(end); ++word)
+			{
+				visibility[word] = 0;
+			}
+
+			// lanes are padded to the register width, the last register may read past end.
+			uint32 const last = (end + P::Width - 1) / P::Width * P::Width;
+			assert(last <= paddedSize);
+			(void)paddedSize;
+			for (uint32 i = begin; i < last; i += P::Width)
+			{
+				uint32 mask = test(i);
+				// padding lanes hold unspecified values.
+				if (i + P::Width > end)
+				{
+					mask &= (1u << (end - i)) - 1;
+				}
+				visibility[i / CullWordBits] |= mask << (i % CullWordBits);
+			}
+		}
+	}
+
+	// Spheres of centers[i] and radii[i].
+	template <class T>
+	void CullSpheres(uint32* visibility, FrustumT<T> const& frustum, VectorStream<T, 3> const& centers, ScalarStream<T> const& radii, uint32 begin, uint32 end)
+	{
+		using P = SIMD::Pack<T>;
+		assert(centers.Size() == radii.Size());
+		Detail::BroadcastFrustum<T> const f(frustum);
+		auto const zero = P::Set(T(0));
+		Detail::Cull<T>(visibility, centers.Size(), centers.PaddedSize(), begin, end, [&](uint32 i)
+		{
+			auto const x = P::Load(centers.Lane(0) + i), y = P::Load(centers.Lane(1) + i), z = P::Load(centers.Lane(2) + i);
+			auto const r = P::Load(radii.Lane(0) + i);
+			// inside when distance + radius >= 0 for every plane.
+			auto nearest = P::Add(f.Distance(0, x, y, z), r);
+			for (uint32 p = 1; p < 6; ++p)
+			{
+				nearest = P::Min(nearest, P::Add(f.Distance(p, x, y, z), r));
+			}
+			return P::MaskLessEqual(zero, nearest);
+		});
+	}
+
+	template <class T>
+	void CullSpheres(uint32* visibility, FrustumT<T> const& frustum, VectorStream<T, 3> const& centers, ScalarStream<T> const& radii)
+	{
+		CullSpheres(visibility, frustum, centers, radii, 0, centers.Size());
+	}
+
+	// Boxes of minimum[i] and maximum[i], same test as FrustumT::Intersects(AABB).
+	template <class T>
+	void CullBoxes(uint32* visibility, FrustumT<T> const& frustum, VectorStream<T, 3> const& minimum, VectorStream<T, 3> const& maximum, uint32 begin, uint32 end)
+	{
+		using P = SIMD::Pack<T>;
+		assert(minimum.Size() == maximum.Size());
+		Detail::BroadcastFrustum<T> const f(frustum);
+		auto const zero = P::Set(T(0));
+		Detail::Cull<T>(visibility, minimum.Size(), minimum.PaddedSize(), begin, end, [&](uint32 i)
+		{
+			// the corner farthest along the plane normal, chosen per plane since the normal is the same for every lane.
+			auto corner = [&](uint32 p, uint32 c)
+			{
+				return P::Load((f.positive[p][c] ? maximum.Lane(c) : minimum.Lane(c)) + i);
+			};
+			auto nearest = f.Distance(0, corner(0, 0), corner(0, 1), corner(0, 2));
+			for (uint32 p = 1; p < 6; ++p)
+			{
+				nearest = P::Min(nearest, f.Distance(p, corner(p, 0), corner(p, 1), corner(p, 2)));
+			}
+			return P::MaskLessEqual(zero, nearest);
+		});
+	}
+
+	template <class T>
+	void CullBoxes(uint32* visibility, FrustumT<T> const& frustum, VectorStream<T, 3> const& minimum, VectorStream<T, 3> const& maximum)
+	{
+		CullBoxes(visibility, frustum, minimum, maximum, 0, minimum.Size());
+	}
+
+	/*
+	*	Splits [0, count) into at most taskCount ranges aligned to CullWordBits and hands them to the caller's scheduler.
+	*	run(n, task) must call task(t) once for every t in [0, n), on any threads, and return when all of them have finished.
+	*	e.g. CullParallel(count, workers, [&](uint32 n, auto&& task) { pool.ForEach(n, task); }, [&](uint32 begin, uint32 end) { CullBoxes(visibility, frustum, minimum, maximum, begin, end); });
+	*/
+	template <class Run, class Cull>
+	void CullParallel(uint32 count, uint32 taskCount, Run&& run, Cull&& cull)
+	{
+		uint32 const words = CullWordCount(count);
+		taskCount = taskCount == 0 ? 1 : (taskCount < words ? taskCount : (words > 0 ? words : 1));
+		uint32 const wordsPerTask = words > 0 ? (words + taskCount - 1) / taskCount : 1;
+		// rounding up may leave the last tasks without words, drop them.
+		taskCount = words > 0 ? (words + wordsPerTask - 1) / wordsPerTask : 1;
+		uint32 const chunk = wordsPerTask * CullWordBits;
+
+		run(taskCount, [&cull, count, chunk](uint32 t)
+		{
+			uint32 const begin = t * chunk;
+			cull(begin, begin + chunk < count ? begin + chunk : count);
+		});
+	}
+
+	/*
+	*	Same split over threadCount std::threads, the calling thread takes the first range.
+	*	Every call starts and joins threadCount - 1 threads, tens of microseconds each, so per frame culling must go through the overload above with a thread pool.
+	*/
+	template <class Cull>
+	void CullParallel(uint32 count, uint32 threadCount, Cull&& cull)
+	{
+		CullParallel(count, threadCount, [](uint32 taskCount, auto&& task)
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(taskCount - 1);
+			for (uint32 t = 1; t < taskCount; ++t)
+			{
+				threads.emplace_back([&task, t]() { task(t); });
+			}
+			task(0);
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+		}, cull);
+	}
+
+	/*
+	*	Writes the indices of visible objects in ascending order, returns how many were written.
+	*	indices must hold count elements in the worst case.
+	*/
+	inline uint32 CompactVisible(uint32* indices, uint32 const* visibility, uint32 count) noexcept
+	{
+		uint32 written = 0;
+		for (uint32 word = 0; word < CullWordCount(count); ++word)
+		{
+			uint32 bits = visibility[word];
+			while (bits != 0)
+			{
+				indices[written++] = word * CullWordBits + CountTrailingZeros(bits);
+				bits &= bits - 1;
+			}
+		}
+		return written;
+	}
+}
@@ -0,0 +1,316 @@
+#pragma once
+#include "Core/BasicType.h"
+#include "Math/SIMD.h"
+#include "Math/Vector.h"
+#include "Math/Quaternion.h"
+#include "Math/VectorStream.h"
+#include "Math/BatchTransform.h"
+#include <cassert>
+#include <type_traits>
+
+namespace X
+{
+	// SoA quaternions, lanes are x, y, z and w.
+	template <class T>
+	using QuaternionStream = VectorStream<T, 4>;
+
+	namespace Detail
+	{
+		// Width quaternions held in registers, P is a SIMD::Pack.
+		template <class P>
+		struct PackQuaternion
+		{
+			using Type = typename P::Type;
+
+			Type x, y, z, w;
+
+			template <class T>
+			static PackQuaternion Set(Quaternion<T> const& q) noexcept
+			{
+				return { P::Set(q.x), P::Set(q.y), P::Set(q.z), P::Set(q.w) };
+			}
+
+			template <class T>
+			static PackQuaternion Load(QuaternionStream<T> const& q, uint32 i) noexcept
+			{
+				return { P::Load(q.Lane(0) + i), P::Load(q.Lane(1) + i), P::Load(q.Lane(2) + i), P::Load(q.Lane(3) + i) };
+			}
+
+			template <class T>
+			void Store(QuaternionStream<T>& q, uint32 i) const noexcept
+			{
+				P::Store(q.Lane(0) + i, x);
+				P::Store(q.Lane(1) + i, y);
+				P::Store(q.Lane(2) + i, z);
+				P::Store(q.Lane(3) + i, w);
+			}
+
+			Type Dot(PackQuaternion const& r) const noexcept
+			{
+				return P::MulAdd(x, r.x, P::MulAdd(y, r.y, P::MulAdd(z, r.z, P::Mul(w, r.w))));
+			}
+
+			// l * lw + r * rw
+			static PackQuaternion Blend(PackQuaternion const& l, Type lw, PackQuaternion const& r, Type rw) noexcept
+			{
+				return { P::MulAdd(l.x, lw, P::Mul(r.x, rw)), P::MulAdd(l.y, lw, P::Mul(r.y, rw)), P::MulAdd(l.z, lw, P::Mul(r.z, rw)), P::MulAdd(l.w, lw, P::Mul(r.w, rw)) };
+			}
+
+			PackQuaternion Normalized() const noexcept
+			{
+				Type const length = P::Sqrt(Dot(*this));
+				return { P::Div(x, length), P::Div(y, length), P::Div(z, length), P::Div(w, length) };
+			}
+
+			// Same as RotateByQuaternion() for unit quaternion, v + w * t + cross(q, t) where t = 2 * cross(q, v).
+			void Rotate(Type& vx, Type& vy, Type& vz) const noexcept
+			{
+				Type const two = P::Set(2);
+				Type const tx = P::Mul(two, P::MulSub(y, vz, P::Mul(z, vy)));
+				Type const ty = P::Mul(two, P::MulSub(z, vx, P::Mul(x, vz)));
+				Type const tz = P::Mul(two, P::MulSub(x, vy, P::Mul(y, vx)));
+				vx = P::Add(P::MulAdd(w, tx, vx), P::MulSub(y, tz, P::Mul(z, ty)));
+				vy = P::Add(P::MulAdd(w, ty, vy), P::MulSub(z, tx, P::Mul(x, tz)));
+				vz = P::Add(P::MulAdd(w, tz, vz), P::MulSub(x, ty, P::Mul(y, tx)));
+			}
+		};
+
+		template <class T>
+		Vector<T, 3> RotateUnit(Quaternion<T> const& q, Vector<T, 3> const& v) noexcept
+		{
+			Vector<T, 3> const axis(q.x, q.y, q.z);
+			Vector<T, 3> const t = T(2) * Cross(axis, v);
+			return v + q.w * t + Cross(axis, t);
+		}
+
+		/*
+		*	Interpolation weights for from and to, the sign of d flips the weight of to for the shorter arc.
+		*/
+		struct NlerpWeights
+		{
+			static constexpr bool Normalize = true;
+
+			template <class T, class P>
+			static void Get(typename P::Type d, typename P::Type t, typename P::Type& wFrom, typename P::Type& wTo) noexcept
+			{
+				wFrom = P::Sub(P::Set(T(1)), t);
+				wTo = P::CopySign(t, d);
+			}
+		};
+
+		// Same polynomial as SlerpFast().
+		struct SlerpFastWeights
+		{
+			static constexpr bool Normalize = true;
+
+			template <class T, class P>
+			static void Get(typename P::Type d, typename P::Type t, typename P::Type& wFrom, typename P::Type& wTo) noexcept
+			{
+				auto const x = P::Abs(d);
+				auto const a = P::MulAdd(x, P::MulAdd(x, P::MulSub(x, P::Set(T(-1.43519)), P::Set(T(-3.55645))), P::Set(T(-3.2452))), P::Set(T(1.0904)));
+				auto const b = P::MulAdd(x, P::MulAdd(x, P::Set(T(0.215638)), P::Set(T(-1.06021))), P::Set(T(0.848013)));
+				auto const h = P::Sub(t, P::Set(T(0.5)));
+				auto const k = P::MulAdd(P::Mul(a, h), h, b);
+				auto const ct = P::MulAdd(P::Mul(P::Mul(t, h), P::Sub(t, P::Set(T(1)))), k, t);
+				NlerpWeights::Get<T, P>(d, ct, wFrom, wTo);
+			}
+		};
+
+		/*
+		*	sin(t * theta) / sin(theta) by a polynomial of cos(theta), no trigonometric function involved and no special case near 0.
+		*	see 'A Fast and Accurate Algorithm for Computing SLERP', David Eberly. Maximum error is about 3e-5.
+		*/
+		struct SlerpWeights
+		{
+			static constexpr bool Normalize = false;
+
+			static constexpr uint32 Order = 8;
+			static constexpr float64 Mu = 1.85298109240830;
+
+			static constexpr float64 U(uint32 i) noexcept { return (i + 1 < Order ? 1.0 : Mu) / ((i + 1) * (2 * i + 3)); }
+			static constexpr float64 V(uint32 i) noexcept { return (i + 1 < Order ? 1.0 : Mu) * (i + 1) / (2 * i + 3); }
+
+			template <class T, class P>
+			static typename P::Type Evaluate(typename P::Type xm1, typename P::Type t) noexcept
+			{
+				auto const one = P::Set(T(1));
+				auto const t2 = P::Mul(t, t);
+				auto result = one;
+				for (uint32 i = Order; i-- > 0;)
+				{
+					auto const b = P::Mul(P::MulSub(P::Set(T(U(i))), t2, P::Set(T(V(i)))), xm1);
+					result = P::MulAdd(b, result, one);
+				}
+				return P::Mul(t, result);
+			}
+
+			template <class T, class P>
+			static void Get(typename P::Type d, typename P::Type t, typename P::Type& wFrom, typename P::Type& wTo) noexcept
+			{
+				auto const xm1 = P::Sub(P::Abs(d), P::Set(T(1)));
+				wFrom = Evaluate<T, P>(xm1, P::Sub(P::Set(T(1)), t));
+				wTo = P::CopySign(Evaluate<T, P>(xm1, t), d);
+			}
+		};
+
+		template <class W, class T>
+		void Interpolate(QuaternionStream<T>& out, QuaternionStream<T> const& from, QuaternionStream<T> const& to, ScalarStream<T> const* ts, T t)
+		{
+			static_assert(std::is_floating_point_v<T>, "Interpolation for floating point types only.");
+			using P = SIMD::Pack<T>;
+			using Q = PackQuaternion<P>;
+			assert(from.Size() == to.Size());
+			assert(ts == nullptr || ts->Size() == from.Size());
+			out.Resize(from.Size());
+			auto const uniform = P::Set(t);
+			uint32 const count = from.PaddedSize();
+			for (uint32 i = 0; i < count; i += P::Width)
+			{
+				Q const a = Q::Load(from, i), b = Q::Load(to, i);
+				typename P::Type wa, wb;
+				W::template Get<T, P>(a.Dot(b), ts ? P::Load(ts->Lane(0) + i) : uniform, wa, wb);
+				Q const r = Q::Blend(a, wa, b, wb);
+				if constexpr (W::Normalize)
+				{
+					r.Normalized().Store(out, i);
+				}
+				else
+				{
+					r.Store(out, i);
+				}
+			}
+		}
+	}
+
+	/*
+	*	Batched Nlerp(), Slerp() and SlerpFast() over SoA quaternion streams, with per element or uniform t.
+	*	Quaternions must be normalized, the shorter arc is taken.
+	*/
+
+	template <class T>
+	void Nlerp(QuaternionStream<T>& out, QuaternionStream<T> const& from, QuaternionStream<T> const& to, ScalarStream<T> const& t)
+	{
+		Detail::Interpolate<Detail::NlerpWeights, T>(out, from, to, &t, T(0));
+	}
+
+	template <class T>
+	void Nlerp(QuaternionStream<T>& out, QuaternionStream<T> const& from, QuaternionStream<T> const& to, T t)
+	{
+		Detail::Interpolate<Detail::NlerpWeights, T>(out, from, to, nullptr, t);
+	}
+
+	// Polynomial approximation, see Detail::SlerpWeights.
+	template <class T>
+	void Slerp(QuaternionStream<T>& out, QuaternionStream<T> const& from, QuaternionStream<T> const& to, ScalarStream<T> const& t)
+	{
+		Detail::Interpolate<Detail::SlerpWeights, T>(out, from, to, &t, T(0));
+	}
+
+	template <class T>
+	void Slerp(QuaternionStream<T>& out, QuaternionStream<T> const& from, QuaternionStream<T> const& to, T t)
+	{
+		Detail::Interpolate<Detail::SlerpWeights, T>(out, from, to, nullptr, t);
+	}
+
+	template <class T>
+	void SlerpFast(QuaternionStream<T>& out, QuaternionStream<T> const& from, QuaternionStream<T> const& to, ScalarStream<T> const& t)
+	{
+		Detail::Interpolate<Detail::SlerpFastWeights, T>(out, from, to, &t, T(0));
+	}
+
+	template <class T>
+	void SlerpFast(QuaternionStream<T>& out, QuaternionStream<T> const& from, QuaternionStream<T> const& to, T t)
+	{
+		Detail::Interpolate<Detail::SlerpFastWeights, T>(out, from, to, nullptr, t);
+	}
+
+	/*
+	*	Batched RotateByQuaternion() for unit quaternions. out may be the same array as in.
+	*/
+
+	// out[i] = RotateByQuaternion(quaternion, in[i])
+	template <class T>
+	void RotateByQuaternion(Vector<T, 3>* out, Quaternion<T> const& quaternion, Vector<T, 3> const* in, uint32 count) noexcept
+	{
+		uint32 i = 0;
+#if defined(X_SIMD_SSE41)
+		if constexpr (Detail::UseSSE<T>())
+		{
+			auto const q = Detail::PackQuaternion<SIMD::F32x4>::Set(quaternion);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 x, y, z;
+				SIMD::Deinterleave3(in[i].v, x, y, z);
+				q.Rotate(x, y, z);
+				SIMD::Interleave3(out[i].v, x, y, z);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			out[i] = Detail::RotateUnit(quaternion, in[i]);
+		}
+	}
+
+	// out[i] = RotateByQuaternion(quaternions[i], in[i])
+	template <class T>
+	void RotateByQuaternion(Vector<T, 3>* out, Quaternion<T> const* quaternions, Vector<T, 3> const* in, uint32 count) noexcept
+	{
+		uint32 i = 0;
+#if defined(X_SIMD_SSE41)
+		if constexpr (Detail::UseSSE<T>())
+		{
+			for (; i + 4 <= count; i += 4)
+			{
+				Detail::PackQuaternion<SIMD::F32x4> q = { SIMD::Load4(quaternions[i].v), SIMD::Load4(quaternions[i + 1].v), SIMD::Load4(quaternions[i + 2].v), SIMD::Load4(quaternions[i + 3].v) };
+				_MM_TRANSPOSE4_PS(q.x, q.y, q.z, q.w);
+				__m128 x, y, z;
+				SIMD::Deinterleave3(in[i].v, x, y, z);
+				q.Rotate(x, y, z);
+				SIMD::Interleave3(out[i].v, x, y, z);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			out[i] = Detail::RotateUnit(quaternions[i], in[i]);
+		}
+	}
+
+	template <class T>
+	void RotateByQuaternion(VectorStream<T, 3>& out, Quaternion<T> const& quaternion, VectorStream<T, 3> const& in)
+	{
+		using P = SIMD::Pack<T>;
+		auto const q = Detail::PackQuaternion<P>::Set(quaternion);
+		out.Resize(in.Size());
+		uint32 const count = in.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto x = P::Load(in.Lane(0) + i), y = P::Load(in.Lane(1) + i), z = P::Load(in.Lane(2) + i);
+			q.Rotate(x, y, z);
+			P::Store(out.Lane(0) + i, x);
+			P::Store(out.Lane(1) + i, y);
+			P::Store(out.Lane(2) + i, z);
+		}
+	}
+
+	template <class T>
+	void RotateByQuaternion(VectorStream<T, 3>& out, QuaternionStream<T> const& quaternions, VectorStream<T, 3> const& in)
+	{
+		using P = SIMD::Pack<T>;
+		assert(quaternions.Size() == in.Size());
+		out.Resize(in.Size());
+		uint32 const count = in.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto const q = Detail::PackQuaternion<P>::Load(quaternions, i);
+			auto x = P::Load(in.Lane(0) + i), y = P::Load(in.Lane(1) + i), z = P::Load(in.Lane(2) + i);
+			q.Rotate(x, y, z);
+			P::Store(out.Lane(0) + i, x);
+			P::Store(out.Lane(1) + i, y);
+			P::Store(out.Lane(2) + i, z);
+		}
+	}
+
+	using QSF32 = QuaternionStream<float32>;
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include "Core/BasicType.h"
+#include "Math/SIMD.h"
+#include "Math/Vector.h"
+#include "Math/DualQuaternion.h"
+#include "Math/VectorStream.h"
+#include "Math/BatchQuaternion.h"
+#include <cassert>
+#include <type_traits>
+
+namespace X
+{
+	// Bone influences per vertex, lanes of the index and weight streams.
+	constexpr uint32 SkinInfluenceCount = 4;
+
+	namespace Detail
+	{
+		// Width dual quaternions held in registers, P is a SIMD::Pack.
+		template <class P>
+		struct PackDualQuaternion
+		{
+			using Type = typename P::Type;
+
+			PackQuaternion<P> real, dual;
+
+			// Loads bones[indices[j]] into lane j, lanes past size use bone 0.
+			template <class T>
+			static PackDualQuaternion Gather(DualQuaternion<T> const* bones, uint32 boneCount, uint32 const* indices, uint32 size) noexcept
+			{
+				alignas(64) T lanes[8][P::Width];
+				for (uint32 j = 0; j < P::Width; ++j)
+				{
+					uint32 const index = j < size ? indices[j] : 0;
+					assert(index < boneCount);
+					(void)boneCount;
+					DualQuaternion<T> const& bone = bones[index];
+					for (uint32 c = 0; c < 4; ++c)
+					{
+						lanes[c][j] = bone.real.v[c];
+						lanes[4 + c][j] = bone.dual.v[c];
+					}
+				}
+				return {
+					{ P::Load(lanes[0]), P::Load(lanes[1]), P::Load(lanes[2]), P::Load(lanes[3]) },
+					{ P::Load(lanes[4]), P::Load(lanes[5]), P::Load(lanes[6]), P::Load(lanes[7]) } };
+			}
+
+			// this += r * weight
+			void Accumulate(PackDualQuaternion const& r, Type weight) noexcept
+			{
+				real = { P::MulAdd(r.real.x, weight, real.x), P::MulAdd(r.real.y, weight, real.y), P::MulAdd(r.real.z, weight, real.z), P::MulAdd(r.real.w, weight, real.w) };
+				dual = { P::MulAdd(r.dual.x, weight, dual.x), P::MulAdd(r.dual.y, weight, dual.y), P::MulAdd(r.dual.z, weight, dual.z), P::MulAdd(r.dual.w, weight, dual.w) };
+			}
+
+			// Same as DualQuaternion::Normalized().
+			PackDualQuaternion Normalized() const noexcept
+			{
+				Type const inverseLength = P::Reciprocal(P::Sqrt(real.Dot(real)));
+				PackQuaternion<P> const r = { P::Mul(real.x, inverseLength), P::Mul(real.y, inverseLength), P::Mul(real.z, inverseLength), P::Mul(real.w, inverseLength) };
+				PackQuaternion<P> const d = { P::Mul(dual.x, inverseLength), P::Mul(dual.y, inverseLength), P::Mul(dual.z, inverseLength), P::Mul(dual.w, inverseLength) };
+				Type const rd = r.Dot(d);
+				return { r, { P::Sub(d.x, P::Mul(r.x, rd)), P::Sub(d.y, P::Mul(r.y, rd)), P::Sub(d.z, P::Mul(r.z, rd)), P::Sub(d.w, P::Mul(r.w, rd)) } };
+			}
+
+			void TransformDirection(Type& x, Type& y, Type& z) const noexcept
+			{
+				real.Rotate(x, y, z);
+			}
+
+			// Same as DualQuaternion::TransformPoint(), translation is 2 * (rw * dv - dw * rv + cross(rv, dv)).
+			void TransformPoint(Type& x, Type& y, Type& z) const noexcept
+			{
+				Type const two = P::Set(2);
+				Type const tx = P::Mul(two, P::Add(P::MulSub(real.w, dual.x, P::Mul(dual.w, real.x)), P::MulSub(real.y, dual.z, P::Mul(real.z, dual.y))));
+				Type const ty = P::Mul(two, P::Add(P::MulSub(real.w, dual.y, P::Mul(dual.w, real.y)), P::MulSub(real.z, dual.x, P::Mul(real.x, dual.z))));
+				Type const tz = P::Mul(two, P::Add(P::MulSub(real.w, dual.z, P::Mul(dual.w, real.z)), P::MulSub(real.x, dual.y, P::Mul(real.y, dual.x))));
+				real.Rotate(x, y, z);
+				x = P::Add(x, tx);
+				y = P::Add(y, ty);
+				z = P::Add(z, tz);
+			}
+		};
+	}
+
+	/*
+	*	Linear blend dual quaternion skinning, see 'Geometric Skinning with Approximate Dual Quaternion Blending', Kavan et al.
+	*	Every vertex blends SkinInfluenceCount bones, unused influences have weight 0. Weights need not sum to 1, the blend is normalized.
+	*	Bones are flipped to the hemisphere of the first influence, so the first influence should have the largest weight.
+	*	Bone gathering is scalar, the blend and the transform run on full SIMD registers.
+	*/
+	template <class T>
+	void SkinDualQuaternion(VectorStream<T, 3>& outPositions, VectorStream<T, 3>* outNormals,
+		DualQuaternion<T> const* bones, uint32 boneCount,
+		VectorStream<uint32, SkinInfluenceCount> const& boneIndices, VectorStream<T, SkinInfluenceCount> const& boneWeights,
+		VectorStream<T, 3> const& positions, VectorStream<T, 3> const* normals)
+	{
+		static_assert(std::is_floating_point_v<T>, "SkinDualQuaternion() for floating point types only.");
+		using P = SIMD::Pack<T>;
+		using DQ = Detail::PackDualQuaternion<P>;
+		uint32 const size = positions.Size();
+		assert(boneCount > 0);
+		assert(boneIndices.Size() == size && boneWeights.Size() == size);
+		assert((outNormals == nullptr) == (normals == nullptr));
+		assert(normals == nullptr || normals->Size() == size);
+
+		outPositions.Resize(size);
+		if (outNormals)
+		{
+			outNormals->Resize(size);
+		}
+
+		uint32 const count = positions.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			uint32 const valid = i < size ? size - i : 0;
+
+			DQ const pivot = DQ::Gather(bones, boneCount, boneIndices.Lane(0) + i, valid);
+			DQ blend = {};
+			blend.Accumulate(pivot, P::Load(boneWeights.Lane(0) + i));
+			for (uint32 k = 1; k < SkinInfluenceCount; ++k)
+			{
+				DQ const bone = DQ::Gather(bones, boneCount, boneIndices.Lane(k) + i, valid);
+				// antipodal bone, q and -q are the same rotation but blend the long way.
+				blend.Accumulate(bone, P::CopySign(P::Load(boneWeights.Lane(k) + i), pivot.real.Dot(bone.real)));
+			}
+			DQ const transform = blend.Normalized();
+
+			auto x = P::Load(positions.Lane(0) + i), y = P::Load(positions.Lane(1) + i), z = P::Load(positions.Lane(2) + i);
+			transform.TransformPoint(x, y, z);
+			P::Store(outPositions.Lane(0) + i, x);
+			P::Store(outPositions.Lane(1) + i, y);
+			P::Store(outPositions.Lane(2) + i, z);
+
+			if (normals)
+			{
+				x = P::Load(normals->Lane(0) + i), y = P::Load(normals->Lane(1) + i), z = P::Load(normals->Lane(2) + i);
+				transform.TransformDirection(x, y, z);
+				P::Store(outNormals->Lane(0) + i, x);
+				P::Store(outNormals->Lane(1) + i, y);
+				P::Store(outNormals->Lane(2) + i, z);
+			}
+		}
+	}
+
+	template <class T>
+	void SkinDualQuaternion(VectorStream<T, 3>& outPositions, VectorStream<T, 3>& outNormals,
+		DualQuaternion<T> const* bones, uint32 boneCount,
+		VectorStream<uint32, SkinInfluenceCount> const& boneIndices, VectorStream<T, SkinInfluenceCount> const& boneWeights,
+		VectorStream<T, 3> const& positions, VectorStream<T, 3> const& normals)
+	{
+		SkinDualQuaternion(outPositions, &outNormals, bones, boneCount, boneIndices, boneWeights, positions, &normals);
+	}
+
+	template <class T>
+	void SkinDualQuaternion(VectorStream<T, 3>& outPositions,
+		DualQuaternion<T> const* bones, uint32 boneCount,
+		VectorStream<uint32, SkinInfluenceCount> const& boneIndices, VectorStream<T, SkinInfluenceCount> const& boneWeights,
+		VectorStream<T, 3> const& positions)
+	{
+		SkinDualQuaternion<T>(outPositions, nullptr, bones, boneCount, boneIndices, boneWeights, positions, nullptr);
+	}
+}
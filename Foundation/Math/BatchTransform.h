@@ -0,0 +1,309 @@
+#pragma once
+#include "Core/BasicType.h"
+#include "Math/SIMD.h"
+#include "Math/MathHelper.h"
+#include "Math/Vector.h"
+#include "Math/Matrix.h"
+#include "Math/VectorStream.h"
+#include <cassert>
+#include <type_traits>
+
+namespace X
+{
+	enum class ReciprocalMode
+	{
+		Exact,
+		// Approximated reciprocal refined by one Newton-Raphson step, SIMD paths only.
+		Fast,
+	};
+
+	namespace Detail
+	{
+		// Matrix elements broadcast to registers once per batch, P is a SIMD::Pack.
+		template <class P>
+		struct BroadcastMatrix
+		{
+			using Type = typename P::Type;
+
+			Type m[16];
+
+			template <class T>
+			explicit BroadcastMatrix(Matrix<T, 4, 4> const& matrix) noexcept
+			{
+				T const* data = matrix.Data();
+				for (uint32 i = 0; i < 16; ++i)
+				{
+					m[i] = P::Set(data[i]);
+				}
+			}
+
+			Type Row(uint32 r, Type x, Type y, Type z, Type w) const noexcept { return P::MulAdd(m[r], x, P::MulAdd(m[4 + r], y, P::MulAdd(m[8 + r], z, P::Mul(m[12 + r], w)))); }
+			Type RowPoint(uint32 r, Type x, Type y, Type z) const noexcept { return P::MulAdd(m[r], x, P::MulAdd(m[4 + r], y, P::MulAdd(m[8 + r], z, m[12 + r]))); }
+			Type RowDirection(uint32 r, Type x, Type y, Type z) const noexcept { return P::MulAdd(m[r], x, P::MulAdd(m[4 + r], y, P::Mul(m[8 + r], z))); }
+
+			// Same as Transform() for 3 dimension vector, w is 1 and affine division is done on the result.
+			void Point(Type& x, Type& y, Type& z, ReciprocalMode mode) const noexcept
+			{
+				Type const w = RowPoint(3, x, y, z);
+				Type const inverseW = mode == ReciprocalMode::Fast ? P::ReciprocalFast(w) : P::Reciprocal(w);
+				Type const tx = RowPoint(0, x, y, z);
+				Type const ty = RowPoint(1, x, y, z);
+				Type const tz = RowPoint(2, x, y, z);
+				x = P::Mul(tx, inverseW);
+				y = P::Mul(ty, inverseW);
+				z = P::Mul(tz, inverseW);
+			}
+
+			void Direction(Type& x, Type& y, Type& z) const noexcept
+			{
+				Type const tx = RowDirection(0, x, y, z);
+				Type const ty = RowDirection(1, x, y, z);
+				Type const tz = RowDirection(2, x, y, z);
+				x = tx;
+				y = ty;
+				z = tz;
+			}
+		};
+
+		template <class T>
+		constexpr bool UseSSE() noexcept
+		{
+#if defined(X_SIMD_SSE41)
+			return std::is_same_v<T, float32>;
+#else
+			return false;
+#endif
+		}
+	}
+
+	/*
+	*	Batched versions of Transform() and TransformDirection(), the matrix is broadcast once per call.
+	*	out may be the same array as in.
+	*/
+
+	// out[i] = Transform(matrix, in[i]), including the affine division.
+	template <class T>
+	void TransformPoints(Vector<T, 3>* out, Matrix<T, 4, 4> const& matrix, Vector<T, 3> const* in, uint32 count, ReciprocalMode mode = ReciprocalMode::Exact) noexcept
+	{
+		uint32 i = 0;
+#if defined(X_SIMD_SSE41)
+		if constexpr (Detail::UseSSE<T>())
+		{
+			Detail::BroadcastMatrix<SIMD::F32x4> const m(matrix);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 x, y, z;
+				SIMD::Deinterleave3(in[i].v, x, y, z);
+				m.Point(x, y, z, mode);
+				SIMD::Interleave3(out[i].v, x, y, z);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			Vector<T, 3> const v = in[i];
+			MathHelper::TransformHelper<T, 3>::DoTransform(out[i].v, matrix.Data(), v.v, T(1));
+		}
+	}
+
+	template <class T>
+	void TransformPoints(Vector<T, 3>* points, Matrix<T, 4, 4> const& matrix, uint32 count, ReciprocalMode mode = ReciprocalMode::Exact) noexcept
+	{
+		TransformPoints(points, matrix, points, count, mode);
+	}
+
+	// out[i] = TransformDirection(matrix, in[i])
+	template <class T>
+	void TransformDirections(Vector<T, 3>* out, Matrix<T, 4, 4> const& matrix, Vector<T, 3> const* in, uint32 count) noexcept
+	{
+		uint32 i = 0;
+#if defined(X_SIMD_SSE41)
+		if constexpr (Detail::UseSSE<T>())
+		{
+			Detail::BroadcastMatrix<SIMD::F32x4> const m(matrix);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 x, y, z;
+				SIMD::Deinterleave3(in[i].v, x, y, z);
+				m.Direction(x, y, z);
+				SIMD::Interleave3(out[i].v, x, y, z);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			Vector<T, 3> const v = in[i];
+			MathHelper::TransformHelper<T, 3>::DoTransformDirection(out[i].v, matrix.Data(), v.v);
+		}
+	}
+
+	template <class T>
+	void TransformDirections(Vector<T, 3>* directions, Matrix<T, 4, 4> const& matrix, uint32 count) noexcept
+	{
+		TransformDirections(directions, matrix, directions, count);
+	}
+
+	// out[i] = TransformDirection(matrix, in[i]), w of the result is 0.
+	template <class T>
+	void TransformDirections(Vector<T, 4>* out, Matrix<T, 4, 4> const& matrix, Vector<T, 4> const* in, uint32 count) noexcept
+	{
+		uint32 i = 0;
+#if defined(X_SIMD_SSE41)
+		if constexpr (Detail::UseSSE<T>())
+		{
+			__m128 const c0 = SIMD::Load4(matrix.v[0].v), c1 = SIMD::Load4(matrix.v[1].v), c2 = SIMD::Load4(matrix.v[2].v);
+			for (; i < count; ++i)
+			{
+				__m128 const v = SIMD::Load4(in[i].v);
+				__m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+				r = SIMD::MulAdd(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), r);
+				r = SIMD::MulAdd(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), r);
+				SIMD::Store4(out[i].v, _mm_blend_ps(r, _mm_setzero_ps(), 0x8));
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			Vector<T, 4> const v = in[i];
+			MathHelper::TransformHelper<T, 4>::DoTransformDirection(out[i].v, matrix.Data(), v.v);
+		}
+	}
+
+	template <class T>
+	void TransformDirections(Vector<T, 4>* directions, Matrix<T, 4, 4> const& matrix, uint32 count) noexcept
+	{
+		TransformDirections(directions, matrix, directions, count);
+	}
+
+	// out[i] = matrix * in[i], no division.
+	template <class T>
+	void TransformHomogeneous(Vector<T, 4>* out, Matrix<T, 4, 4> const& matrix, Vector<T, 4> const* in, uint32 count) noexcept
+	{
+		uint32 i = 0;
+#if defined(X_SIMD_SSE41)
+		if constexpr (Detail::UseSSE<T>())
+		{
+			__m128 const c0 = SIMD::Load4(matrix.v[0].v), c1 = SIMD::Load4(matrix.v[1].v), c2 = SIMD::Load4(matrix.v[2].v), c3 = SIMD::Load4(matrix.v[3].v);
+			for (; i < count; ++i)
+			{
+				__m128 const v = SIMD::Load4(in[i].v);
+				__m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+				r = SIMD::MulAdd(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), r);
+				r = SIMD::MulAdd(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), r);
+				r = SIMD::MulAdd(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), r);
+				SIMD::Store4(out[i].v, r);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			Vector<T, 4> const v = in[i];
+			MathHelper::TransformHelper<T, 4>::DoTransform(out[i].v, matrix.Data(), v.v, T(1));
+		}
+	}
+
+	template <class T>
+	void TransformHomogeneous(Vector<T, 4>* vectors, Matrix<T, 4, 4> const& matrix, uint32 count) noexcept
+	{
+		TransformHomogeneous(vectors, matrix, vectors, count);
+	}
+
+	// out[i] = matrix * (in[i], 1), no division. Used to produce clip space positions.
+	template <class T>
+	void TransformHomogeneous(Vector<T, 4>* out, Matrix<T, 4, 4> const& matrix, Vector<T, 3> const* in, uint32 count) noexcept
+	{
+		uint32 i = 0;
+#if defined(X_SIMD_SSE41)
+		if constexpr (Detail::UseSSE<T>())
+		{
+			__m128 const c0 = SIMD::Load4(matrix.v[0].v), c1 = SIMD::Load4(matrix.v[1].v), c2 = SIMD::Load4(matrix.v[2].v), c3 = SIMD::Load4(matrix.v[3].v);
+			for (; i < count; ++i)
+			{
+				__m128 const v = SIMD::Load3(in[i].v);
+				__m128 r = SIMD::MulAdd(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)), c3);
+				r = SIMD::MulAdd(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), r);
+				r = SIMD::MulAdd(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), r);
+				SIMD::Store4(out[i].v, r);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			Vector<T, 4> const v(in[i], T(1));
+			MathHelper::TransformHelper<T, 4>::DoTransform(out[i].v, matrix.Data(), v.v, T(1));
+		}
+	}
+
+	/*
+	*	SoA versions, run on full SIMD registers over the padded stream.
+	*/
+
+	template <class T>
+	void TransformPoints(VectorStream<T, 3>& out, Matrix<T, 4, 4> const& matrix, VectorStream<T, 3> const& in, ReciprocalMode mode = ReciprocalMode::Exact)
+	{
+		using P = SIMD::Pack<T>;
+		Detail::BroadcastMatrix<P> const m(matrix);
+		out.Resize(in.Size());
+		uint32 const count = in.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto x = P::Load(in.Lane(0) + i), y = P::Load(in.Lane(1) + i), z = P::Load(in.Lane(2) + i);
+			m.Point(x, y, z, mode);
+			P::Store(out.Lane(0) + i, x);
+			P::Store(out.Lane(1) + i, y);
+			P::Store(out.Lane(2) + i, z);
+		}
+	}
+
+	template <class T>
+	void TransformDirections(VectorStream<T, 3>& out, Matrix<T, 4, 4> const& matrix, VectorStream<T, 3> const& in)
+	{
+		using P = SIMD::Pack<T>;
+		Detail::BroadcastMatrix<P> const m(matrix);
+		out.Resize(in.Size());
+		uint32 const count = in.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto x = P::Load(in.Lane(0) + i), y = P::Load(in.Lane(1) + i), z = P::Load(in.Lane(2) + i);
+			m.Direction(x, y, z);
+			P::Store(out.Lane(0) + i, x);
+			P::Store(out.Lane(1) + i, y);
+			P::Store(out.Lane(2) + i, z);
+		}
+	}
+
+	template <class T>
+	void TransformHomogeneous(VectorStream<T, 4>& out, Matrix<T, 4, 4> const& matrix, VectorStream<T, 4> const& in)
+	{
+		using P = SIMD::Pack<T>;
+		Detail::BroadcastMatrix<P> const m(matrix);
+		out.Resize(in.Size());
+		uint32 const count = in.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto const x = P::Load(in.Lane(0) + i), y = P::Load(in.Lane(1) + i), z = P::Load(in.Lane(2) + i), w = P::Load(in.Lane(3) + i);
+			auto const tx = m.Row(0, x, y, z, w), ty = m.Row(1, x, y, z, w), tz = m.Row(2, x, y, z, w), tw = m.Row(3, x, y, z, w);
+			P::Store(out.Lane(0) + i, tx);
+			P::Store(out.Lane(1) + i, ty);
+			P::Store(out.Lane(2) + i, tz);
+			P::Store(out.Lane(3) + i, tw);
+		}
+	}
+
+	template <class T>
+	void TransformHomogeneous(VectorStream<T, 4>& out, Matrix<T, 4, 4> const& matrix, VectorStream<T, 3> const& in)
+	{
+		using P = SIMD::Pack<T>;
+		Detail::BroadcastMatrix<P> const m(matrix);
+		out.Resize(in.Size());
+		uint32 const count = in.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto const x = P::Load(in.Lane(0) + i), y = P::Load(in.Lane(1) + i), z = P::Load(in.Lane(2) + i);
+			P::Store(out.Lane(0) + i, m.RowPoint(0, x, y, z));
+			P::Store(out.Lane(1) + i, m.RowPoint(1, x, y, z));
+			P::Store(out.Lane(2) + i, m.RowPoint(2, x, y, z));
+			P::Store(out.Lane(3) + i, m.RowPoint(3, x, y, z));
+		}
+	}
+}
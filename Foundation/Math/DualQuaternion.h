@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Math/BasicMath.h"
+#include "Math/Vector.h"
+#include "Math/Matrix.h"
+#include "Math/Quaternion.h"
+#include <cmath>
+
+namespace X
+{
+	/*
+	*	Dual quaternion real + e * dual, represents a rigid transform when normalized.
+	*	real is the rotation, dual is 0.5 * (translation, 0) * real.
+	*	Composition follows matrix order, (l * r) applies r first.
+	*/
+	template <typename T>
+	class DualQuaternion
+	{
+	public:
+		static DualQuaternion const Identity;
+
+		Quaternion<T> real;
+		Quaternion<T> dual;
+
+		constexpr DualQuaternion() noexcept = default;
+
+		constexpr DualQuaternion(Quaternion<T> const& real, Quaternion<T> const& dual) noexcept : real(real), dual(dual) {}
+
+		/*
+		*	@rotation: unit quaternion.
+		*	@translation: applied after rotation.
+		*/
+		constexpr DualQuaternion(Quaternion<T> const& rotation, Vector<T, 3> const& translation) noexcept
+			: real(rotation), dual(Quaternion<T>(translation, T(0)) * rotation * T(0.5)) {}
+
+		/*
+		*	Rigid transform matrix, the 3x3 part must be a rotation and the last row (0, 0, 0, 1).
+		*/
+		explicit DualQuaternion(Matrix<T, 4, 4> const& m) noexcept
+			: DualQuaternion(RotationFromMatrix(m), Vector<T, 3>(m.v[3][0], m.v[3][1], m.v[3][2])) {}
+
+		template <typename U>
+		constexpr explicit DualQuaternion(DualQuaternion<U> const& r) noexcept : real(r.real), dual(r.dual) {}
+
+		constexpr Quaternion<T> const& Rotation() const noexcept { return real; }
+
+		constexpr Vector<T, 3> Translation() const noexcept
+		{
+			// 2 * dual * conjugate(real)
+			Quaternion<T> const t = dual * real.Conjugate();
+			return Vector<T, 3>(t.v[0] + t.v[0], t.v[1] + t.v[1], t.v[2] + t.v[2]);
+		}
+
+		constexpr DualQuaternion const& operator+() const noexcept { return *this; }
+		constexpr DualQuaternion operator-() const noexcept { return DualQuaternion(-real, -dual); }
+
+		constexpr DualQuaternion& operator+=(DualQuaternion const& r) noexcept { real += r.real; dual += r.dual; return *this; }
+		constexpr DualQuaternion& operator-=(DualQuaternion const& r) noexcept { real -= r.real; dual -= r.dual; return *this; }
+		constexpr DualQuaternion& operator*=(DualQuaternion const& r) noexcept { return *this = *this * r; }
+		constexpr DualQuaternion& operator*=(T const& r) noexcept { real *= r; dual *= r; return *this; }
+
+		/*
+		*	Unit real part and dual part orthogonal to it, required after blending.
+		*/
+		constexpr DualQuaternion Normalized() const noexcept
+		{
+			T const inverseLength = T(1) / real.Length();
+			Quaternion<T> const r = real * inverseLength;
+			Quaternion<T> const d = dual * inverseLength;
+			return DualQuaternion(r, d - r * Dot(r, d));
+		}
+
+		// Quaternion conjugate of both parts, the inverse of a unit dual quaternion.
+		constexpr DualQuaternion Conjugate() const noexcept { return DualQuaternion(real.Conjugate(), dual.Conjugate()); }
+
+		constexpr DualQuaternion RigidInversed() const noexcept { return Conjugate(); }
+
+		constexpr Vector<T, 3> TransformPoint(Vector<T, 3> const& p) const noexcept
+		{
+			return TransformDirection(p) + Translation();
+		}
+
+		constexpr Vector<T, 3> TransformDirection(Vector<T, 3> const& d) const noexcept
+		{
+			Vector<T, 3> const axis(real.v[0], real.v[1], real.v[2]);
+			Vector<T, 3> const t = T(2) * Cross(axis, d);
+			return d + real.v[3] * t + Cross(axis, t);
+		}
+
+		constexpr Matrix<T, 4, 4> ToMatrix() const noexcept
+		{
+			// same as MatrixFromQuaternion() with translation in the last column.
+			T const x2 = real.v[0] + real.v[0], y2 = real.v[1] + real.v[1], z2 = real.v[2] + real.v[2];
+			T const xx2 = real.v[0] * x2, xy2 = real.v[0] * y2, xz2 = real.v[0] * z2;
+			T const yy2 = real.v[1] * y2, yz2 = real.v[1] * z2, zz2 = real.v[2] * z2;
+			T const wx2 = real.v[3] * x2, wy2 = real.v[3] * y2, wz2 = real.v[3] * z2;
+			Vector<T, 3> const t = Translation();
+
+			return Matrix<T, 4, 4>(
+				1 - yy2 - zz2, xy2 + wz2, xz2 - wy2, T(0),
+				xy2 - wz2, 1 - xx2 - zz2, yz2 + wx2, T(0),
+				xz2 + wy2, yz2 - wx2, 1 - xx2 - yy2, T(0),
+				t[0], t[1], t[2], T(1));
+		}
+
+	private:
+		static Quaternion<T> RotationFromMatrix(Matrix<T, 4, 4> const& m) noexcept
+		{
+			// see Real-Time Rendering, 3rd. 4.3.2 Quaternion Transforms, largest component first for stability.
+			T const m00 = m.v[0][0], m10 = m.v[0][1], m20 = m.v[0][2];
+			T const m01 = m.v[1][0], m11 = m.v[1][1], m21 = m.v[1][2];
+			T const m02 = m.v[2][0], m12 = m.v[2][1], m22 = m.v[2][2];
+
+			T const trace = m00 + m11 + m22;
+			if (trace > T(0))
+			{
+				T const s = std::sqrt(trace + T(1)) * T(2);
+				return Quaternion<T>((m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s, s * T(0.25));
+			}
+			else if (m00 > m11 && m00 > m22)
+			{
+				T const s = std::sqrt(T(1) + m00 - m11 - m22) * T(2);
+				return Quaternion<T>(s * T(0.25), (m01 + m10) / s, (m02 + m20) / s, (m21 - m12) / s);
+			}
+			else if (m11 > m22)
+			{
+				T const s = std::sqrt(T(1) + m11 - m00 - m22) * T(2);
+				return Quaternion<T>((m01 + m10) / s, s * T(0.25), (m12 + m21) / s, (m02 - m20) / s);
+			}
+			else
+			{
+				T const s = std::sqrt(T(1) + m22 - m00 - m11) * T(2);
+				return Quaternion<T>((m02 + m20) / s, (m12 + m21) / s, s * T(0.25), (m10 - m01) / s);
+			}
+		}
+	};
+
+	template <typename T>
+	DualQuaternion<T> const DualQuaternion<T>::Identity = DualQuaternion(Quaternion<T>(T(0), T(0), T(0), T(1)), Quaternion<T>(T(0), T(0), T(0), T(0)));
+
+
+	template <typename T>
+	constexpr DualQuaternion<T> operator+(DualQuaternion<T> const& l, DualQuaternion<T> const& r) noexcept { DualQuaternion<T> v = l; v += r; return v; }
+
+	template <typename T>
+	constexpr DualQuaternion<T> operator-(DualQuaternion<T> const& l, DualQuaternion<T> const& r) noexcept { DualQuaternion<T> v = l; v -= r; return v; }
+
+	template <typename T>
+	constexpr DualQuaternion<T> operator*(DualQuaternion<T> const& l, DualQuaternion<T> const& r) noexcept
+	{
+		return DualQuaternion<T>(l.real * r.real, l.real * r.dual + l.dual * r.real);
+	}
+
+	template <typename T>
+	constexpr DualQuaternion<T> operator*(DualQuaternion<T> const& l, T const& r) noexcept { DualQuaternion<T> v = l; v *= r; return v; }
+	template <typename T>
+	constexpr DualQuaternion<T> operator*(T const& l, DualQuaternion<T> const& r) noexcept { DualQuaternion<T> v = r; v *= l; return v; }
+
+	template <typename T>
+	constexpr bool operator==(DualQuaternion<T> const& l, DualQuaternion<T> const& r) noexcept { return l.real == r.real && l.dual == r.dual; }
+
+	template <typename T>
+	constexpr bool operator!=(DualQuaternion<T> const& l, DualQuaternion<T> const& r) noexcept { return l.real != r.real || l.dual != r.dual; }
+
+	using DQF32 = DualQuaternion<float32>;
+	using DQF64 = DualQuaternion<float64>;
+}
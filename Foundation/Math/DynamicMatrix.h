@@ -0,0 +1,516 @@
+#pragma once
+#include "Core/BasicType.h"
+#include "Math/SIMD.h"
+#include "Math/Vector.h"
+#include "Math/PositionAndOffset.h"
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace X
+{
+	/*
+	*	Non-owning view of a rows x columns matrix, element (r, c) is at data[r * rowStride + c * columnStride].
+	*	rowStride 1 is the column-major layout of Matrix, Block() and Transposed() are views of the same elements.
+	*	T is const for read only views.
+	*/
+	template <class T>
+	class MatrixView
+	{
+	public:
+		constexpr MatrixView() noexcept = default;
+		// Column-major with columns packed one after another.
+		constexpr MatrixView(T* data, uint32 rows, uint32 columns) noexcept : MatrixView(data, rows, columns, 1, rows) {}
+		constexpr MatrixView(T* data, uint32 rows, uint32 columns, uint32 rowStride, uint32 columnStride) noexcept
+			: data(data), rows(rows), columns(columns), rowStride(rowStride), columnStride(columnStride)
+		{
+		}
+
+		template <class U, class = std::enable_if_t<std::is_same_v<T, U const>>>
+		constexpr MatrixView(MatrixView<U> const& r) noexcept : MatrixView(r.Data(), r.Rows(), r.Columns(), r.RowStride(), r.ColumnStride()) {}
+
+		constexpr uint32 Rows() const noexcept { return rows; }
+		constexpr uint32 Columns() const noexcept { return columns; }
+		constexpr uint32 RowStride() const noexcept { return rowStride; }
+		constexpr uint32 ColumnStride() const noexcept { return columnStride; }
+		constexpr T* Data() const noexcept { return data; }
+
+		// index is (row, column).
+		constexpr T& operator[](Index2UI index) const noexcept
+		{
+			assert(index.X() < rows && index.Y() < columns);
+			return data[std::size_t(index.X()) * rowStride + std::size_t(index.Y()) * columnStride];
+		}
+
+		constexpr MatrixView Block(uint32 row, uint32 column, uint32 blockRows, uint32 blockColumns) const noexcept
+		{
+			assert(row + blockRows <= rows && column + blockColumns <= columns);
+			return MatrixView(data + std::size_t(row) * rowStride + std::size_t(column) * columnStride, blockRows, blockColumns, rowStride, columnStride);
+		}
+
+		constexpr MatrixView Transposed() const noexcept
+		{
+			return MatrixView(data, columns, rows, columnStride, rowStride);
+		}
+
+	private:
+		T* data = nullptr;
+		uint32 rows = 0;
+		uint32 columns = 0;
+		uint32 rowStride = 1;
+		uint32 columnStride = 0;
+	};
+
+	// Read only view, T is not deduced from it so a mutable view converts at the call.
+	template <class T>
+	using ConstMatrixView = MatrixView<std::add_const_t<T>>;
+
+	/*
+	*	Dense matrix sized at runtime, column-major like Matrix.
+	*	Every column starts on a cache line and is padded with zeros to whole cache lines.
+	*/
+	template <class T>
+	class DynamicMatrix
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "DynamicMatrix for trivially copyable types only.");
+
+	public:
+		static constexpr uint32 Alignment = 64;
+		static constexpr uint32 Padding = Alignment / sizeof(T) > 0 ? Alignment / sizeof(T) : 1;
+
+		DynamicMatrix() noexcept = default;
+
+		// Zero initialized.
+		DynamicMatrix(uint32 rows, uint32 columns) { Resize(rows, columns); }
+
+		explicit DynamicMatrix(ConstMatrixView<T> view)
+		{
+			Resize(view.Rows(), view.Columns());
+			Copy(View(), view);
+		}
+
+		DynamicMatrix(DynamicMatrix const& other) : DynamicMatrix(other.View()) {}
+
+		DynamicMatrix(DynamicMatrix&& other) noexcept : data(other.data), rows(other.rows), columns(other.columns), stride(other.stride)
+		{
+			other.data = nullptr;
+			other.rows = 0;
+			other.columns = 0;
+			other.stride = 0;
+		}
+
+		DynamicMatrix& operator=(DynamicMatrix const& other)
+		{
+			if (this != &other)
+			{
+				Resize(other.rows, other.columns);
+				Copy(View(), other.View());
+			}
+			return *this;
+		}
+
+		DynamicMatrix& operator=(DynamicMatrix&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Release();
+				data = other.data;
+				rows = other.rows;
+				columns = other.columns;
+				stride = other.stride;
+				other.data = nullptr;
+				other.rows = 0;
+				other.columns = 0;
+				other.stride = 0;
+			}
+			return *this;
+		}
+
+		~DynamicMatrix() noexcept
+		{
+			Release();
+		}
+
+		static DynamicMatrix Identity(uint32 size)
+		{
+			DynamicMatrix result(size, size);
+			for (uint32 i = 0; i < size; ++i)
+			{
+				result.Column(i)[i] = T(1);
+			}
+			return result;
+		}
+
+		uint32 Rows() const noexcept { return rows; }
+		uint32 Columns() const noexcept { return columns; }
+		// Distance between the starts of two columns, Rows() rounded up to Padding.
+		uint32 Stride() const noexcept { return stride; }
+		bool Empty() const noexcept { return rows == 0 || columns == 0; }
+
+		T* Data() noexcept { return data; }
+		T const* Data() const noexcept { return data; }
+
+		T* Column(uint32 index) noexcept { assert(index < columns); return data + std::size_t(index) * stride; }
+		T const* Column(uint32 index) const noexcept { assert(index < columns); return data + std::size_t(index) * stride; }
+
+		// index is (row, column).
+		T& operator[](Index2UI index) noexcept { assert(index.X() < rows); return Column(index.Y())[index.X()]; }
+		T const& operator[](Index2UI index) const noexcept { assert(index.X() < rows); return Column(index.Y())[index.X()]; }
+
+		MatrixView<T> View() noexcept { return MatrixView<T>(data, rows, columns, 1, stride); }
+		MatrixView<T const> View() const noexcept { return MatrixView<T const>(data, rows, columns, 1, stride); }
+
+		// The elements are not kept, the result is zero initialized.
+		void Resize(uint32 newRows, uint32 newColumns)
+		{
+			uint32 const newStride = (newRows + Padding - 1) / Padding * Padding;
+			std::size_t const count = std::size_t(newStride) * newColumns;
+			if (count != std::size_t(stride) * columns)
+			{
+				Release();
+				if (count > 0)
+				{
+					data = static_cast<T*>(::operator new(sizeof(T) * count, std::align_val_t(Alignment)));
+				}
+			}
+			rows = newRows;
+			columns = newColumns;
+			stride = newStride;
+			if (count > 0)
+			{
+				std::memset(data, 0, sizeof(T) * count);
+			}
+		}
+
+	private:
+		void Release() noexcept
+		{
+			if (data)
+			{
+				::operator delete(data, std::align_val_t(Alignment));
+				data = nullptr;
+			}
+			rows = 0;
+			columns = 0;
+			stride = 0;
+		}
+
+	private:
+		T* data = nullptr;
+		uint32 rows = 0;
+		uint32 columns = 0;
+		uint32 stride = 0;
+	};
+
+	template <class T>
+	void Fill(MatrixView<T> out, T const& value) noexcept
+	{
+		for (uint32 c = 0; c < out.Columns(); ++c)
+		{
+			for (uint32 r = 0; r < out.Rows(); ++r)
+			{
+				out[Index2UI(r, c)] = value;
+			}
+		}
+	}
+
+	// out and source have the same size and don't overlap.
+	template <class T>
+	void Copy(MatrixView<T> out, ConstMatrixView<T> source) noexcept
+	{
+		assert(out.Rows() == source.Rows() && out.Columns() == source.Columns());
+		for (uint32 c = 0; c < out.Columns(); ++c)
+		{
+			for (uint32 r = 0; r < out.Rows(); ++r)
+			{
+				out[Index2UI(r, c)] = source[Index2UI(r, c)];
+			}
+		}
+	}
+
+	namespace Detail
+	{
+		/*
+		*	Blocked product in the Goto / BLIS layout. A KC deep slice of r is packed into NR column panels sized for L3,
+		*	MC rows of l into MR row panels sized for L2, and the kernel keeps an MR x NR tile of the result in registers
+		*	while streaming both panels from L1. Packing pads the edges with zeros, so the kernel never branches on size.
+		*/
+		template <class T>
+		struct Gemm
+		{
+			using P = SIMD::Pack<T>;
+			using Type = typename P::Type;
+
+			static constexpr uint32 Width = P::Width;
+			// 2 registers x 6 columns of accumulators plus the loaded panel fit in the 16 SIMD registers.
+			static constexpr uint32 MR = Width == 1 ? 4 : 2 * Width;
+			static constexpr uint32 NR = Width == 1 ? 4 : 6;
+			static constexpr uint32 KC = 256;
+			static constexpr uint32 MC = 8 * MR;
+			static constexpr uint32 NC = 256 * NR;
+			static constexpr uint32 Alignment = 64;
+
+			// Owns the packed panels of one thread.
+			struct Buffer
+			{
+				T* data;
+
+				explicit Buffer(std::size_t count) : data(static_cast<T*>(::operator new(sizeof(T) * count, std::align_val_t(Alignment)))) {}
+				~Buffer() noexcept { ::operator delete(data, std::align_val_t(Alignment)); }
+
+				Buffer(Buffer const&) = delete;
+				Buffer& operator=(Buffer const&) = delete;
+			};
+
+			static uint32 Min(uint32 l, uint32 r) noexcept { return l < r ? l : r; }
+			static uint32 RoundUp(uint32 v, uint32 multiple) noexcept { return (v + multiple - 1) / multiple * multiple; }
+
+			// For each MR rows, depth times the MR elements of one column.
+			static void PackLeft(T* out, ConstMatrixView<T> l) noexcept
+			{
+				for (uint32 i = 0; i < l.Rows(); i += MR)
+				{
+					uint32 const height = Min(MR, l.Rows() - i);
+					for (uint32 k = 0; k < l.Columns(); ++k, out += MR)
+					{
+						T const* column = &l[Index2UI(i, k)];
+						uint32 r = 0;
+						for (; r < height; ++r)
+						{
+							out[r] = column[std::size_t(r) * l.RowStride()];
+						}
+						for (; r < MR; ++r)
+						{
+							out[r] = T(0);
+						}
+					}
+				}
+			}
+
+			// For each NR columns, depth times the NR elements of one row.
+			static void PackRight(T* out, ConstMatrixView<T> r) noexcept
+			{
+				for (uint32 j = 0; j < r.Columns(); j += NR)
+				{
+					uint32 const width = Min(NR, r.Columns() - j);
+					for (uint32 k = 0; k < r.Rows(); ++k, out += NR)
+					{
+						T const* row = &r[Index2UI(k, j)];
+						uint32 c = 0;
+						for (; c < width; ++c)
+						{
+							out[c] = row[std::size_t(c) * r.ColumnStride()];
+						}
+						for (; c < NR; ++c)
+						{
+							out[c] = T(0);
+						}
+					}
+				}
+			}
+
+			// tile = l * r over depth, tile is MR x NR column-major, l and r are packed panels.
+			static void Kernel(T* tile, T const* l, T const* r, uint32 depth) noexcept
+			{
+				Type accumulator[MR / Width][NR];
+				Detail::Unroll<NR>([&](uint32 j) { Detail::Unroll<MR / Width>([&](uint32 i) { accumulator[i][j] = P::Set(T(0)); }); });
+				for (uint32 k = 0; k < depth; ++k, l += MR, r += NR)
+				{
+					Type column[MR / Width];
+					Detail::Unroll<MR / Width>([&](uint32 i) { column[i] = P::Load(l + i * Width); });
+					Detail::Unroll<NR>([&](uint32 j)
+					{
+						Type const broadcast = P::Set(r[j]);
+						Detail::Unroll<MR / Width>([&](uint32 i) { accumulator[i][j] = P::MulAdd(column[i], broadcast, accumulator[i][j]); });
+					});
+				}
+				Detail::Unroll<NR>([&](uint32 j) { Detail::Unroll<MR / Width>([&](uint32 i) { P::Store(tile + j * MR + i * Width, accumulator[i][j]); }); });
+			}
+
+			// out += l * r
+			static void MultiplyAdd(MatrixView<T> out, ConstMatrixView<T> l, ConstMatrixView<T> r)
+			{
+				uint32 const m = out.Rows();
+				uint32 const n = out.Columns();
+				uint32 const depth = l.Columns();
+				if (m == 0 || n == 0 || depth == 0)
+				{
+					return;
+				}
+
+				uint32 const kc = Min(KC, depth);
+				Buffer const left(std::size_t(RoundUp(Min(MC, m), MR)) * kc);
+				Buffer const right(std::size_t(RoundUp(Min(NC, n), NR)) * kc);
+				alignas(Alignment) T tile[MR * NR];
+
+				for (uint32 jc = 0; jc < n; jc += NC)
+				{
+					uint32 const nc = Min(NC, n - jc);
+					for (uint32 pc = 0; pc < depth; pc += KC)
+					{
+						uint32 const pk = Min(KC, depth - pc);
+						PackRight(right.data, r.Block(pc, jc, pk, nc));
+						for (uint32 ic = 0; ic < m; ic += MC)
+						{
+							uint32 const mc = Min(MC, m - ic);
+							PackLeft(left.data, l.Block(ic, pc, mc, pk));
+							for (uint32 jr = 0; jr < nc; jr += NR)
+							{
+								uint32 const width = Min(NR, nc - jr);
+								for (uint32 ir = 0; ir < mc; ir += MR)
+								{
+									uint32 const height = Min(MR, mc - ir);
+									Kernel(tile, left.data + std::size_t(ir) * pk, right.data + std::size_t(jr) * pk, pk);
+									for (uint32 j = 0; j < width; ++j)
+									{
+										T* column = &out[Index2UI(ic + ir, jc + jr + j)];
+										for (uint32 i = 0; i < height; ++i)
+										{
+											column[std::size_t(i) * out.RowStride()] += tile[j * MR + i];
+										}
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+		};
+	}
+
+	/*
+	*	out += l * r, out doesn't overlap l or r.
+	*	Any layout of view is accepted, the operands are repacked per block so a Transposed() view costs nothing extra.
+	*/
+	template <class T>
+	void MultiplyAdd(MatrixView<T> out, ConstMatrixView<T> l, ConstMatrixView<T> r)
+	{
+		assert(l.Columns() == r.Rows() && out.Rows() == l.Rows() && out.Columns() == r.Columns());
+		Detail::Gemm<T>::MultiplyAdd(out, l, r);
+	}
+
+	// out = l * r, out doesn't overlap l or r.
+	template <class T>
+	void Multiply(MatrixView<T> out, ConstMatrixView<T> l, ConstMatrixView<T> r)
+	{
+		Fill(out, T(0));
+		MultiplyAdd(out, l, r);
+	}
+
+	/*
+	*	Multiply() with the columns of out split into threadCount ranges, the calling thread takes the first range.
+	*	Each thread packs its own panels, so l is packed once per thread.
+	*/
+	template <class T>
+	void MultiplyParallel(MatrixView<T> out, ConstMatrixView<T> l, ConstMatrixView<T> r, uint32 threadCount)
+	{
+		using Gemm = Detail::Gemm<T>;
+		assert(l.Columns() == r.Rows() && out.Rows() == l.Rows() && out.Columns() == r.Columns());
+		uint32 const panels = (out.Columns() + Gemm::NR - 1) / Gemm::NR;
+		threadCount = threadCount == 0 ? 1 : (threadCount < panels ? threadCount : (panels > 0 ? panels : 1));
+		uint32 const chunk = (panels + threadCount - 1) / threadCount * Gemm::NR;
+		uint32 const count = out.Columns();
+
+		auto multiply = [out, l, r](uint32 begin, uint32 end)
+		{
+			Multiply(out.Block(0, begin, out.Rows(), end - begin), l, r.Block(0, begin, r.Rows(), end - begin));
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount - 1);
+		for (uint32 t = 1; t < threadCount; ++t)
+		{
+			uint32 const begin = t * chunk;
+			if (begin >= count)
+			{
+				break;
+			}
+			uint32 const end = begin + chunk < count ? begin + chunk : count;
+			threads.emplace_back([&multiply, begin, end]() { multiply(begin, end); });
+		}
+		multiply(0, chunk < count ? chunk : count);
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	// Resizes out, threadCount above 1 runs MultiplyParallel().
+	template <class T>
+	void Multiply(DynamicMatrix<T>& out, DynamicMatrix<T> const& l, DynamicMatrix<T> const& r, uint32 threadCount = 1)
+	{
+		assert(&out != &l && &out != &r);
+		out.Resize(l.Rows(), r.Columns());
+		if (threadCount > 1)
+		{
+			MultiplyParallel(out.View(), l.View(), r.View(), threadCount);
+		}
+		else
+		{
+			MultiplyAdd(out.View(), l.View(), r.View());
+		}
+	}
+
+	/*
+	*	out = l * r for vectors of l.Rows() and l.Columns() elements, out doesn't overlap r.
+	*	Column-major l is accumulated 4 columns per pass over out, row-major l (e.g. a Transposed() view) as dot products.
+	*/
+	template <class T>
+	void Multiply(T* out, ConstMatrixView<T> l, T const* r) noexcept
+	{
+		uint32 const rows = l.Rows();
+		uint32 const columns = l.Columns();
+		if (rows == 0 || columns == 0)
+		{
+			// no element of l to address, an empty sum for every row.
+			for (uint32 i = 0; i < rows; ++i)
+			{
+				out[i] = T(0);
+			}
+			return;
+		}
+		if (l.RowStride() == 1)
+		{
+			for (uint32 i = 0; i < rows; ++i)
+			{
+				out[i] = T(0);
+			}
+			uint32 c = 0;
+			for (; c + 4 <= columns; c += 4)
+			{
+				T const* c0 = &l[Index2UI(0, c)];
+				T const* c1 = c0 + l.ColumnStride();
+				T const* c2 = c1 + l.ColumnStride();
+				T const* c3 = c2 + l.ColumnStride();
+				T const r0 = r[c], r1 = r[c + 1], r2 = r[c + 2], r3 = r[c + 3];
+				for (uint32 i = 0; i < rows; ++i)
+				{
+					out[i] += c0[i] * r0 + c1[i] * r1 + c2[i] * r2 + c3[i] * r3;
+				}
+			}
+			for (; c < columns; ++c)
+			{
+				T const* c0 = &l[Index2UI(0, c)];
+				for (uint32 i = 0; i < rows; ++i)
+				{
+					out[i] += c0[i] * r[c];
+				}
+			}
+			return;
+		}
+		for (uint32 i = 0; i < rows; ++i)
+		{
+			T const* row = &l[Index2UI(i, 0)];
+			T sum = T(0);
+			for (uint32 c = 0; c < columns; ++c)
+			{
+				sum += row[std::size_t(c) * l.ColumnStride()] * r[c];
+			}
+			out[i] = sum;
+		}
+	}
+}
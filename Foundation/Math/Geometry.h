@@ -1,9 +1,12 @@
 #pragma once
 
 #include "Core/BasicType.h"
+#include "Math/SIMD.h"
 #include "Math/Vector.h"
+#include "Math/Matrix.h"
+#include <cassert>
+#include <limits>
 
-// TODO
 namespace X
 {
 
@@ -24,10 +27,9 @@ namespace X
 
 	public:
 		RayT(Vector<T, 3> const& origin, Vector<T, 3> const& direction)
-			: origin_(origin), direction_(direction.Normalize())
+			: origin_(origin), direction_(direction.Normalized())
 		{
-			auto& zero = Vector<T, 3>::Zero;
-			assert(direction != zero);
+			assert((direction != Vector<T, 3>(T(0))));
 		}
 		RayT(RayT const& r)
 			: origin_(r.origin_), direction_(r.direction_)
@@ -35,7 +37,7 @@ namespace X
 		}
 		template <typename U>
 		RayT(RayT<U> const& r)
-			: origin_(r.origin_), direction_(r.direction_)
+			: origin_(Vector<T, 3>(r.origin_)), direction_(Vector<T, 3>(r.direction_))
 		{
 		}
 
@@ -46,15 +48,14 @@ namespace X
 				origin_ = r.origin_;
 				direction_ = r.direction_;
 			}
+			return *this;
 		}
 		template <typename U>
 		RayT& operator =(RayT<U> const& r)
 		{
-			if (this != &r)
-			{
-				origin_ = r.origin_;
-				direction_ = r.direction_;
-			}
+			origin_ = Vector<T, 3>(r.origin_);
+			direction_ = Vector<T, 3>(r.direction_);
+			return *this;
 		}
 
 		Vector<T, 3> const& GetOrigin() const
@@ -65,7 +66,7 @@ namespace X
 		{
 			return direction_;
 		}
-		Vector<T, 3> const& GetPoint(T const& t) const
+		Vector<T, 3> GetPoint(T const& t) const
 		{
 			return origin_ + t * direction_;
 		}
@@ -76,15 +77,79 @@ namespace X
 	typedef RayT<float32> Ray;
 
 
+	/*
+	*	Line segment from start to end, its points are GetPoint(t) for t in [0, 1].
+	*/
 	template <typename T>
 	class SegmentT
 	{
+		template <typename U>
+		friend class SegmentT;
+
 	public:
-		SegmentT();
+		typedef T ValueType;
 
-	private:
+		typedef ValueType* Pointer;
+		typedef ValueType const* ConstPointer;
 
+		typedef ValueType& Reference;
+		typedef ValueType const& ConstReference;
+
+	public:
+		SegmentT(Vector<T, 3> const& start, Vector<T, 3> const& end)
+			: start_(start), end_(end)
+		{
+		}
+		template <typename U>
+		SegmentT(SegmentT<U> const& r)
+			: start_(Vector<T, 3>(r.start_)), end_(Vector<T, 3>(r.end_))
+		{
+		}
+
+		Vector<T, 3> const& GetStart() const
+		{
+			return start_;
+		}
+		Vector<T, 3> const& GetEnd() const
+		{
+			return end_;
+		}
+		// end - start, not normalized.
+		Vector<T, 3> GetDirection() const
+		{
+			return end_ - start_;
+		}
+		Vector<T, 3> GetPoint(T const& t) const
+		{
+			return start_ + t * (end_ - start_);
+		}
+		T Length() const
+		{
+			return (end_ - start_).Length();
+		}
+
+		// t in [0, 1] of the point closest to point, 0 for a degenerate segment.
+		T ClosestParameter(Vector<T, 3> const& point) const
+		{
+			Vector<T, 3> const direction = end_ - start_;
+			T const lengthSquared = direction.LengthSquared();
+			if (lengthSquared == T(0))
+			{
+				return T(0);
+			}
+			T const t = Dot(point - start_, direction) / lengthSquared;
+			return t < T(0) ? T(0) : (T(1) < t ? T(1) : t);
+		}
+		Vector<T, 3> ClosestPoint(Vector<T, 3> const& point) const
+		{
+			return GetPoint(ClosestParameter(point));
+		}
+
+	private:
+		Vector<T, 3> start_;
+		Vector<T, 3> end_;
 	};
+	typedef SegmentT<float32> Segment;
 
 	/*
 	 *	Plane: Ax + By + Cz + D, represented as normal * p + distance, where p is a point on the plane.
@@ -105,6 +170,11 @@ namespace X
 		typedef ValueType const& ConstReference;
 
 	public:
+		PlaneT()
+			: normal_(T(0)), distance_(T(0))
+		{
+		}
+
 		PlaneT(Vector<T, 3> const& normal, T const& distance)
 			: normal_(normal), distance_(distance)
 		{
@@ -116,7 +186,7 @@ namespace X
 		}
 		template <typename U>
 		PlaneT(PlaneT<U> const& r)
-			: normal_(r.normal_), distance_(r.distance_)
+			: normal_(Vector<T, 3>(r.normal_)), distance_(T(r.distance_))
 		{
 		}
 
@@ -127,15 +197,14 @@ namespace X
 				normal_ = r.normal_;
 				distance_ = r.distance_;
 			}
+			return *this;
 		}
 		template <typename U>
 		PlaneT& operator =(PlaneT<U> const& r)
 		{
-			if (this != &r)
-			{
-				normal_ = r.normal_;
-				distance_ = r.distance_;
-			}
+			normal_ = Vector<T, 3>(r.normal_);
+			distance_ = T(r.distance_);
+			return *this;
 		}
 
 		Vector<T, 3> const& GetNormal() const
@@ -147,20 +216,453 @@ namespace X
 			return distance_;
 		}
 
+		/*
+		*	Signed distance of point, positive on the side normal points to. Only a distance when normal is normalized.
+		*/
+		T Distance(Vector<T, 3> const& point) const
+		{
+			return Dot(normal_, point) + distance_;
+		}
+
+		PlaneT Normalized() const
+		{
+			T const inverseLength = T(1) / normal_.Length();
+			return PlaneT(normal_ * inverseLength, distance_ * inverseLength);
+		}
+
 	private:
 		Vector<T, 3> normal_;
 		T distance_;
 	};
 	typedef PlaneT<float32> Plane;
 
+
+	/*
+	*	Axis aligned bounding box. Default constructed box is empty, minimum at +infinity and maximum at -infinity, so any Merge() replaces it.
+	*/
+	template <typename T, uint32 N>
+	class AABB
+	{
+	public:
+		static constexpr uint32 Dimension = N;
+
+		Vector<T, N> minimum;
+		Vector<T, N> maximum;
+
+		constexpr AABB() noexcept : minimum(std::numeric_limits<T>::infinity()), maximum(-std::numeric_limits<T>::infinity()) {}
+		constexpr AABB(Vector<T, N> const& minimum, Vector<T, N> const& maximum) noexcept : minimum(minimum), maximum(maximum) {}
+
+		template <typename U>
+		constexpr explicit AABB(AABB<U, N> const& r) noexcept : minimum(r.minimum), maximum(r.maximum) {}
+
+		constexpr bool Empty() const noexcept
+		{
+			for (uint32 i = 0; i < N; ++i)
+			{
+				if (maximum[i] < minimum[i])
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		constexpr Vector<T, N> Center() const noexcept { return (minimum + maximum) * T(0.5); }
+		constexpr Vector<T, N> Size() const noexcept { return maximum - minimum; }
+		// Half of Size().
+		constexpr Vector<T, N> Extent() const noexcept { return (maximum - minimum) * T(0.5); }
+
+		constexpr AABB& Merge(Vector<T, N> const& point) noexcept
+		{
+			for (uint32 i = 0; i < N; ++i)
+			{
+				minimum[i] = point[i] < minimum[i] ? point[i] : minimum[i];
+				maximum[i] = maximum[i] < point[i] ? point[i] : maximum[i];
+			}
+			return *this;
+		}
+
+		constexpr AABB& Merge(AABB const& box) noexcept
+		{
+			for (uint32 i = 0; i < N; ++i)
+			{
+				minimum[i] = box.minimum[i] < minimum[i] ? box.minimum[i] : minimum[i];
+				maximum[i] = maximum[i] < box.maximum[i] ? box.maximum[i] : maximum[i];
+			}
+			return *this;
+		}
+
+		// Grows every side by amount, negative amount shrinks.
+		constexpr AABB& Expand(T const& amount) noexcept { return Expand(Vector<T, N>(amount)); }
+		constexpr AABB& Expand(Vector<T, N> const& amount) noexcept
+		{
+			minimum -= amount;
+			maximum += amount;
+			return *this;
+		}
+
+		// Boundary included.
+		constexpr bool Contains(Vector<T, N> const& point) const noexcept
+		{
+			for (uint32 i = 0; i < N; ++i)
+			{
+				if (point[i] < minimum[i] || maximum[i] < point[i])
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		constexpr bool Contains(AABB const& box) const noexcept
+		{
+			for (uint32 i = 0; i < N; ++i)
+			{
+				if (box.minimum[i] < minimum[i] || maximum[i] < box.maximum[i])
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Touching boxes overlap.
+		constexpr bool Overlaps(AABB const& box) const noexcept
+		{
+			for (uint32 i = 0; i < N; ++i)
+			{
+				if (box.maximum[i] < minimum[i] || maximum[i] < box.minimum[i])
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Perimeter for 2 dimensions, the cost metric of SAH.
+		constexpr T SurfaceArea() const noexcept
+		{
+			static_assert(N == 2 || N == 3, "SurfaceArea() for 2 or 3 dimensions only.");
+			Vector<T, N> const size = Size();
+			if constexpr (N == 2)
+			{
+				return T(2) * (size[0] + size[1]);
+			}
+			else
+			{
+				return T(2) * (size[0] * size[1] + size[1] * size[2] + size[2] * size[0]);
+			}
+		}
+
+		constexpr T Volume() const noexcept
+		{
+			Vector<T, N> const size = Size();
+			T volume = size[0];
+			for (uint32 i = 1; i < N; ++i)
+			{
+				volume *= size[i];
+			}
+			return volume;
+		}
+
+		/*
+		*	Bounds of the transformed box, see 'Transforming Axis-Aligned Bounding Boxes', James Arvo, Graphics Gems.
+		*	Matrix must be affine.
+		*/
+		constexpr AABB Transformed(Matrix<T, 4, 4> const& matrix) const noexcept
+		{
+			static_assert(N == 3, "Transformed() for 3 dimensions only.");
+			AABB result(Vector<T, 3>(matrix.v[3][0], matrix.v[3][1], matrix.v[3][2]), Vector<T, 3>(matrix.v[3][0], matrix.v[3][1], matrix.v[3][2]));
+			for (uint32 i = 0; i < 3; ++i)
+			{
+				for (uint32 j = 0; j < 3; ++j)
+				{
+					T const a = matrix.v[j][i] * minimum[j];
+					T const b = matrix.v[j][i] * maximum[j];
+					result.minimum[i] += a < b ? a : b;
+					result.maximum[i] += a < b ? b : a;
+				}
+			}
+			return result;
+		}
+
+		/*
+		*	Slab test against ray origin + t * direction for t in [tMin, tMax], tNear receives the entry distance.
+		*	inverseDirection is 1 / direction per component, zero components give infinities and still work.
+		*/
+		constexpr bool Intersects(Vector<T, 3> const& origin, Vector<T, 3> const& inverseDirection, T tMin, T tMax, T& tNear) const noexcept
+		{
+			static_assert(N == 3, "Ray intersection for 3 dimensions only.");
+			for (uint32 i = 0; i < 3; ++i)
+			{
+				T t0 = (minimum[i] - origin[i]) * inverseDirection[i];
+				T t1 = (maximum[i] - origin[i]) * inverseDirection[i];
+				if (t1 < t0)
+				{
+					T const t = t0;
+					t0 = t1;
+					t1 = t;
+				}
+				tMin = tMin < t0 ? t0 : tMin;
+				tMax = t1 < tMax ? t1 : tMax;
+				if (tMax < tMin)
+				{
+					return false;
+				}
+			}
+			tNear = tMin;
+			return true;
+		}
+
+		bool Intersects(RayT<T> const& ray, T& tNear) const noexcept
+		{
+			Vector<T, 3> const& d = ray.GetDirection();
+			Vector<T, 3> const inverseDirection(T(1) / d[0], T(1) / d[1], T(1) / d[2]);
+			return Intersects(ray.GetOrigin(), inverseDirection, T(0), std::numeric_limits<T>::max(), tNear);
+		}
+
+		// tNear receives the entry parameter in [0, 1], see SegmentT::GetPoint().
+		bool Intersects(SegmentT<T> const& segment, T& tNear) const noexcept
+		{
+			Vector<T, 3> const d = segment.GetDirection();
+			Vector<T, 3> const inverseDirection(T(1) / d[0], T(1) / d[1], T(1) / d[2]);
+			return Intersects(segment.GetStart(), inverseDirection, T(0), T(1), tNear);
+		}
+	};
+
+	template <typename T, uint32 N>
+	constexpr bool operator==(AABB<T, N> const& l, AABB<T, N> const& r) noexcept { return l.minimum == r.minimum && l.maximum == r.maximum; }
+	template <typename T, uint32 N>
+	constexpr bool operator!=(AABB<T, N> const& l, AABB<T, N> const& r) noexcept { return !(l == r); }
+
+	/*
+	*	W boxes in SoA layout, tested together in one SIMD pass. Results are bitmasks, bit i for box i.
+	*	Unused slots hold a box at +infinity, which nothing intersects or overlaps.
+	*/
+	template <typename T, uint32 W>
+	class AABBPacket
+	{
+		using P = typename SIMD::PackOfWidth<T, W>::Type;
+		static_assert(W % P::Width == 0, "Packet width must be a multiple of the register width.");
+
+	public:
+		static constexpr uint32 Width = W;
+
+		alignas(64) T minimum[3][W];
+		T maximum[3][W];
+
+		AABBPacket() noexcept
+		{
+			for (uint32 i = 0; i < W; ++i)
+			{
+				Clear(i);
+			}
+		}
+
+		void Clear(uint32 index) noexcept
+		{
+			assert(index < W);
+			for (uint32 c = 0; c < 3; ++c)
+			{
+				minimum[c][index] = std::numeric_limits<T>::infinity();
+				maximum[c][index] = std::numeric_limits<T>::infinity();
+			}
+		}
+
+		void Set(uint32 index, AABB<T, 3> const& box) noexcept
+		{
+			assert(index < W);
+			if (box.Empty())
+			{
+				Clear(index);
+				return;
+			}
+			for (uint32 c = 0; c < 3; ++c)
+			{
+				minimum[c][index] = box.minimum[c];
+				maximum[c][index] = box.maximum[c];
+			}
+		}
+
+		AABB<T, 3> Get(uint32 index) const noexcept
+		{
+			assert(index < W);
+			return AABB<T, 3>(Vector<T, 3>(minimum[0][index], minimum[1][index], minimum[2][index]), Vector<T, 3>(maximum[0][index], maximum[1][index], maximum[2][index]));
+		}
+
+		// Same as AABB::Intersects() for every box, tNear of missed boxes is unspecified. tMax must be finite, or unused slots may report a hit.
+		uint32 Intersects(Vector<T, 3> const& origin, Vector<T, 3> const& inverseDirection, T tMin, T tMax, T tNear[W]) const noexcept
+		{
+			uint32 mask = 0;
+			for (uint32 i = 0; i < W; i += P::Width)
+			{
+				auto nearest = P::Set(tMin), farthest = P::Set(tMax);
+				for (uint32 c = 0; c < 3; ++c)
+				{
+					auto const o = P::Set(origin[c]), id = P::Set(inverseDirection[c]);
+					auto const t0 = P::Mul(P::Sub(P::Load(minimum[c] + i), o), id);
+					auto const t1 = P::Mul(P::Sub(P::Load(maximum[c] + i), o), id);
+					nearest = P::Max(nearest, P::Min(t0, t1));
+					farthest = P::Min(farthest, P::Max(t0, t1));
+				}
+				alignas(64) T result[P::Width];
+				P::Store(result, nearest);
+				for (uint32 j = 0; j < P::Width; ++j)
+				{
+					tNear[i + j] = result[j];
+				}
+				mask |= P::MaskLessEqual(nearest, farthest) << i;
+			}
+			return mask;
+		}
+
+		uint32 Intersects(RayT<T> const& ray, T tNear[W]) const noexcept
+		{
+			Vector<T, 3> const& d = ray.GetDirection();
+			Vector<T, 3> const inverseDirection(T(1) / d[0], T(1) / d[1], T(1) / d[2]);
+			return Intersects(ray.GetOrigin(), inverseDirection, T(0), std::numeric_limits<T>::max(), tNear);
+		}
+
+		// tNear receives the entry parameters in [0, 1], see SegmentT::GetPoint().
+		uint32 Intersects(SegmentT<T> const& segment, T tNear[W]) const noexcept
+		{
+			Vector<T, 3> const d = segment.GetDirection();
+			Vector<T, 3> const inverseDirection(T(1) / d[0], T(1) / d[1], T(1) / d[2]);
+			return Intersects(segment.GetStart(), inverseDirection, T(0), T(1), tNear);
+		}
+
+		uint32 Overlaps(AABB<T, 3> const& box) const noexcept
+		{
+			uint32 mask = 0;
+			for (uint32 i = 0; i < W; i += P::Width)
+			{
+				uint32 m = (1u << P::Width) - 1;
+				for (uint32 c = 0; c < 3; ++c)
+				{
+					m &= P::MaskLessEqual(P::Load(minimum[c] + i), P::Set(box.maximum[c]));
+					m &= P::MaskLessEqual(P::Set(box.minimum[c]), P::Load(maximum[c] + i));
+				}
+				mask |= m << i;
+			}
+			return mask;
+		}
+	};
+
+	using AABB2F32 = AABB<float32, 2>;
+	using AABB3F32 = AABB<float32, 3>;
+	using AABB3F64 = AABB<float64, 3>;
+	using AABB4 = AABBPacket<float32, 4>;
+	using AABB8 = AABBPacket<float32, 8>;
+
+	/*
+	*	Six planes with normals pointing inside. A point is inside when its distance to every plane is not negative.
+	*/
 	template <typename T>
 	class FrustumT
 	{
 	public:
-		FrustumT();
+		enum PlaneIndex : uint32
+		{
+			Left,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			Far,
+			PlaneCount,
+		};
 
-	private:
+		enum class DepthRange
+		{
+			// [-1, 1], as FrustumProjectionMatrix() produces.
+			NegativeOneToOne,
+			ZeroToOne,
+		};
 
+	public:
+		/*
+		*	Extract planes from clip space, see 'Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix', Gribb and Hartmann.
+		*	@viewProjection: projection * view, planes are in world space.
+		*/
+		explicit FrustumT(Matrix<T, 4, 4> const& viewProjection, DepthRange depthRange = DepthRange::NegativeOneToOne)
+		{
+			auto row = [&viewProjection](uint32 r)
+			{
+				return Vector<T, 4>(viewProjection.v[0][r], viewProjection.v[1][r], viewProjection.v[2][r], viewProjection.v[3][r]);
+			};
+			// a plane without normal, e.g. the far plane of an infinite projection, can't be normalized.
+			// It keeps everything or nothing by the sign of its distance, so Intersects() and the batched culling agree.
+			auto plane = [](Vector<T, 4> const& p)
+			{
+				Vector<T, 3> const normal(p[0], p[1], p[2]);
+				if (normal.LengthSquared() == T(0))
+				{
+					return PlaneT<T>(Vector<T, 3>(T(0)), p[3] < T(0) ? T(-1) : T(1));
+				}
+				return PlaneT<T>(normal, p[3]).Normalized();
+			};
+
+			Vector<T, 4> const x = row(0), y = row(1), z = row(2), w = row(3);
+			planes_[Left] = plane(w + x);
+			planes_[Right] = plane(w - x);
+			planes_[Bottom] = plane(w + y);
+			planes_[Top] = plane(w - y);
+			planes_[Near] = plane(depthRange == DepthRange::NegativeOneToOne ? w + z : z);
+			planes_[Far] = plane(w - z);
+		}
+
+		PlaneT<T> const& GetPlane(uint32 index) const
+		{
+			assert(index < PlaneCount);
+			return planes_[index];
+		}
+
+		bool Contains(Vector<T, 3> const& point) const
+		{
+			for (PlaneT<T> const& plane : planes_)
+			{
+				if (plane.Distance(point) < T(0))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Sphere test, conservative near the frustum corners.
+		bool Intersects(Vector<T, 3> const& center, T const& radius) const
+		{
+			for (PlaneT<T> const& plane : planes_)
+			{
+				if (plane.Distance(center) < -radius)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Box test by the corner farthest along each plane normal, conservative near the frustum corners.
+		bool Intersects(AABB<T, 3> const& box) const
+		{
+			for (PlaneT<T> const& plane : planes_)
+			{
+				Vector<T, 3> const& n = plane.GetNormal();
+				Vector<T, 3> const farthest(
+					n[0] < T(0) ? box.minimum[0] : box.maximum[0],
+					n[1] < T(0) ? box.minimum[1] : box.maximum[1],
+					n[2] < T(0) ? box.minimum[2] : box.maximum[2]);
+				if (plane.Distance(farthest) < T(0))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		PlaneT<T> planes_[PlaneCount];
 	};
+	typedef FrustumT<float32> Frustum;
 
 }
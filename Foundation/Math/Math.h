@@ -4,6 +4,7 @@
 #include "Math/Angle.h"
 #include "Math/Vector.h"
 #include "Math/Matrix.h"
+#include "Math/AffineTransform.h"
 #include "Math/Quaternion.h"
 
 
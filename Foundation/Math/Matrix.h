@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Core/BasicType.h"
+#include "Core/Utility.h"
+#include "Math/SIMD.h"
 #include "Math/MathHelper.h"
 #include "Math/BasicMath.h"
 #include "Math/Vector.h"
@@ -13,6 +15,79 @@ namespace X
 	template <class T, uint32 R, uint32 C>
 	class Matrix;
 
+	/*
+	*	Matrices of any size, 3x3 and 4x4 are specialized with named elements, inversion and SIMD paths.
+	*	C columns of R elements, operations are unrolled over the columns like the generic Vector.
+	*/
+	template <class T, uint32 R, uint32 C>
+	class Matrix
+	{
+	public:
+		static constexpr uint32 Count = R * C;
+
+		static Matrix const Zero;
+		static Matrix const Identity;
+
+		Vector<Vector<T, R>, C> v;
+
+		constexpr Matrix() noexcept = default;
+		/*
+		*	Create a scalar equivalent matrix, fill principal diagonal with r.
+		*/
+		explicit constexpr Matrix(T const& r) noexcept : v(Vector<T, R>(T(0)))
+		{
+			for (uint32 i = 0; i < (R < C ? R : C); ++i)
+			{
+				v[i][i] = r;
+			}
+		}
+
+		template <class... Columns, class = std::enable_if_t<sizeof...(Columns) == C && C != 1 && (std::is_convertible_v<Columns const&, Vector<T, R>> && ...)>>
+		constexpr Matrix(Columns const&... columns) noexcept : v(columns...) {}
+
+		template <class U>
+		constexpr explicit Matrix(Matrix<U, R, C> const& r) noexcept : v(r.v) {}
+
+		constexpr T const& operator[](Index2UI index) const noexcept { return v[index.Y()][index.X()]; }
+		constexpr T& operator[](Index2UI index) noexcept { return v[index.Y()][index.X()]; }
+
+		constexpr Vector<T, R> const& operator[](uint32 index) const { return v[index]; }
+		constexpr Vector<T, R>& operator[](uint32 index) { return v[index]; }
+
+		constexpr Vector<T, C> Row(uint32 index) const noexcept { return Row(index, std::make_integer_sequence<uint32, C>()); }
+		constexpr Vector<T, R> const& Column(uint32 index) const noexcept { return v[index]; }
+
+		constexpr Matrix const& operator+() const noexcept { return *this; }
+		constexpr Matrix operator-() const noexcept { return Matrix(-v); }
+
+		constexpr Matrix& operator+=(Matrix const& r) noexcept { v += r.v; return *this; }
+		constexpr Matrix& operator-=(Matrix const& r) noexcept { v -= r.v; return *this; }
+		constexpr Matrix& operator*=(T const& r) noexcept { Detail::Unroll<C>([this, &r](uint32 c) { v[c] *= r; }); return *this; }
+		constexpr Matrix& operator/=(T const& r) noexcept { Detail::Unroll<C>([this, &r](uint32 c) { v[c] /= r; }); return *this; }
+
+		constexpr Matrix<T, C, R> Transposed() const noexcept { return Transposed(std::make_integer_sequence<uint32, R>()); }
+
+		T const* Data() const noexcept
+		{
+			return v.Data()->Data();
+		}
+
+		constexpr Matrix(Vector<Vector<T, R>, C> const& columns) noexcept : v(columns) {}
+
+	private:
+		template <uint32... I>
+		constexpr Vector<T, C> Row(uint32 index, std::integer_sequence<uint32, I...>) const noexcept { return Vector<T, C>(v[I][index]...); }
+
+		template <uint32... I>
+		constexpr Matrix<T, C, R> Transposed(std::integer_sequence<uint32, I...>) const noexcept { return Matrix<T, C, R>(Row(I)...); }
+	};
+
+	template <class T, uint32 R, uint32 C>
+	Matrix<T, R, C> const Matrix<T, R, C>::Zero = Matrix(T(0));
+
+	template <class T, uint32 R, uint32 C>
+	Matrix<T, R, C> const Matrix<T, R, C>::Identity = Matrix(T(1));
+
 	template <class T>
 	class Matrix<T, 3, 3>
 	{
@@ -61,7 +136,7 @@ namespace X
 		constexpr Vector<T, C>& operator[](uint32 index) { return v[index]; }
 
 
-		constexpr Vector<T, C> const Row(uint32 index) const noexcept { return Vector<T, C> result(v[0][index], v[1][index], v[2][index]); }
+		constexpr Vector<T, C> const Row(uint32 index) const noexcept { return Vector<T, C>(v[0][index], v[1][index], v[2][index]); }
 		constexpr Vector<T, R> const& Column(uint32 index) const noexcept { return v[index]; }
 
 		constexpr Matrix const& operator+() const noexcept { return *this; }
@@ -70,16 +145,16 @@ namespace X
 		constexpr Matrix Transposed() const noexcept
 		{
 			return Matrix(
-				v[0][0], v[0][1], v[0][2],
-				v[1][0], v[1][1], v[1][2],
-				v[2][0], v[2][1], v[2][2]);
+				v[0][0], v[1][0], v[2][0],
+				v[0][1], v[1][1], v[2][1],
+				v[0][2], v[1][2], v[2][2]);
 		}
 
 		constexpr Matrix Inversed() const noexcept
 		{
-			T	m11 = v[0][0], m21 = v[1][0], m31 = v[2][0],
-				m12 = v[0][1], m22 = v[1][1], m32 = v[2][1],
-				m13 = v[0][2], m23 = v[1][2], m33 = v[2][2];
+			T	m11 = v[0][0], m21 = v[0][1], m31 = v[0][2],
+				m12 = v[1][0], m22 = v[1][1], m32 = v[1][2],
+				m13 = v[2][0], m23 = v[2][1], m33 = v[2][2];
 
 			T	_2233 = m22 * m33,
 				_2133 = m21 * m33,
@@ -218,7 +293,7 @@ namespace X
 		constexpr Vector<T, C>& operator[](uint32 index) { return v[index]; }
 
 
-		constexpr Vector<T, C> const Row(uint32 index) const noexcept { return Vector<T, C> result(v[0][index], v[1][index], v[2][index], v[3][index]); }
+		constexpr Vector<T, C> const Row(uint32 index) const noexcept { return Vector<T, C>(v[0][index], v[1][index], v[2][index], v[3][index]); }
 		constexpr Vector<T, R> const& Column(uint32 index) const noexcept { return v[index]; }
 
 		constexpr Matrix const& operator+() const noexcept { return *this; }
@@ -226,19 +301,44 @@ namespace X
 
 		constexpr Matrix Transposed() const noexcept
 		{
+			if constexpr (SIMD::MatrixHelper<T, R, C>::Enabled)
+			{
+				if (!IsConstantEvaluated())
+				{
+					Matrix result = *this;
+					SIMD::MatrixHelper<T, R, C>::Transpose(result.v[0].v, Data());
+					return result;
+				}
+			}
 			return Matrix(
-				v[0][0], v[0][1], v[0][2], v[0][3],
-				v[1][0], v[1][1], v[1][2], v[1][3],
-				v[2][0], v[2][1], v[2][2], v[2][3],
-				v[3][0], v[3][1], v[3][2], v[3][3]);
+				v[0][0], v[1][0], v[2][0], v[3][0],
+				v[0][1], v[1][1], v[2][1], v[3][1],
+				v[0][2], v[1][2], v[2][2], v[3][2],
+				v[0][3], v[1][3], v[2][3], v[3][3]);
 		}
 
 		constexpr Matrix Inversed() const noexcept
 		{
-			T	m11 = v[0][0], m21 = v[1][0], m31 = v[2][0], m41 = v[3][0],
-				m12 = v[0][1], m22 = v[1][1], m32 = v[2][1], m42 = v[3][1],
-				m13 = v[0][2], m23 = v[1][2], m33 = v[2][2], m43 = v[3][2],
-				m14 = v[0][3], m24 = v[1][3], m34 = v[2][3], m44 = v[3][3];
+			if constexpr (SIMD::MatrixHelper<T, R, C>::Enabled)
+			{
+				if (!IsConstantEvaluated())
+				{
+					Matrix result = *this;
+					T const determinant = SIMD::MatrixHelper<T, R, C>::Inverse(result.v[0].v, Data());
+					// non-invertible
+					if (BasicMath::CEqual<T>(determinant, 0))
+					{
+						assert(false);
+						return Matrix(T(1));
+					}
+					return result;
+				}
+			}
+
+			T	m11 = v[0][0], m21 = v[0][1], m31 = v[0][2], m41 = v[0][3],
+				m12 = v[1][0], m22 = v[1][1], m32 = v[1][2], m42 = v[1][3],
+				m13 = v[2][0], m23 = v[2][1], m33 = v[2][2], m43 = v[2][3],
+				m14 = v[3][0], m24 = v[3][1], m34 = v[3][2], m44 = v[3][3];
 
 			T	_1122_2112 = m11 * m22 - m21 * m12,
 				_1132_3112 = m11 * m32 - m31 * m12,
@@ -283,6 +383,75 @@ namespace X
 				(m13 * _2132_3122 - m23 * _1132_3112 + m33 * _1122_2112) * inverseDeterminant);
 		}
 
+		/*
+		*	Inverse of an affine transform, last row must be (0, 0, 0, 1). Much cheaper than Inversed().
+		*/
+		constexpr Matrix AffineInversed() const noexcept
+		{
+			if constexpr (SIMD::MatrixHelper<T, R, C>::Enabled)
+			{
+				if (!IsConstantEvaluated())
+				{
+					Matrix result = *this;
+					T const determinant = SIMD::MatrixHelper<T, R, C>::AffineInverse(result.v[0].v, Data());
+					// non-invertible
+					if (BasicMath::CEqual<T>(determinant, 0))
+					{
+						assert(false);
+						return Matrix(T(1));
+					}
+					return result;
+				}
+			}
+
+			Vector<T, 3> const c0(v[0][0], v[0][1], v[0][2]), c1(v[1][0], v[1][1], v[1][2]), c2(v[2][0], v[2][1], v[2][2]), t(v[3][0], v[3][1], v[3][2]);
+
+			// rows of the adjugate of the 3x3 part
+			Vector<T, 3> const r0 = Cross(c1, c2), r1 = Cross(c2, c0), r2 = Cross(c0, c1);
+
+			T determinant = Dot(c0, r0);
+
+			// non-invertible
+			if (BasicMath::CEqual<T>(determinant, 0))
+			{
+				assert(false);
+				return Matrix(T(1));
+			}
+
+			T inverseDeterminant = T(1) / determinant;
+
+			return Matrix(
+				r0[0] * inverseDeterminant, r1[0] * inverseDeterminant, r2[0] * inverseDeterminant, T(0),
+				r0[1] * inverseDeterminant, r1[1] * inverseDeterminant, r2[1] * inverseDeterminant, T(0),
+				r0[2] * inverseDeterminant, r1[2] * inverseDeterminant, r2[2] * inverseDeterminant, T(0),
+				-Dot(r0, t) * inverseDeterminant, -Dot(r1, t) * inverseDeterminant, -Dot(r2, t) * inverseDeterminant, T(1));
+		}
+
+		/*
+		*	Inverse of a rotation and translation only transform, the 3x3 part must be orthonormal and last row (0, 0, 0, 1).
+		*/
+		constexpr Matrix RigidInversed() const noexcept
+		{
+			if constexpr (SIMD::MatrixHelper<T, R, C>::Enabled)
+			{
+				if (!IsConstantEvaluated())
+				{
+					Matrix result = *this;
+					SIMD::MatrixHelper<T, R, C>::RigidInverse(result.v[0].v, Data());
+					return result;
+				}
+			}
+
+			return Matrix(
+				v[0][0], v[1][0], v[2][0], T(0),
+				v[0][1], v[1][1], v[2][1], T(0),
+				v[0][2], v[1][2], v[2][2], T(0),
+				-(v[0][0] * v[3][0] + v[0][1] * v[3][1] + v[0][2] * v[3][2]),
+				-(v[1][0] * v[3][0] + v[1][1] * v[3][1] + v[1][2] * v[3][2]),
+				-(v[2][0] * v[3][0] + v[2][1] * v[3][1] + v[2][2] * v[3][2]),
+				T(1));
+		}
+
 		constexpr T Determinant() const noexcept
 		{
 			T	m11 = v[0][0], m21 = v[1][0], m31 = v[2][0], m41 = v[3][0],
@@ -324,6 +493,15 @@ namespace X
 	template<class T>
 	constexpr Matrix<T, 4, 4> operator*(Matrix<T, 4, 4> const& l, Matrix<T, 4, 4> const& r) noexcept
 	{
+		if constexpr (SIMD::MatrixHelper<T, 4, 4>::Enabled)
+		{
+			if (!IsConstantEvaluated())
+			{
+				Matrix<T, 4, 4> result = l;
+				SIMD::MatrixHelper<T, 4, 4>::Multiply(result.v[0].v, l.Data(), r.Data());
+				return result;
+			}
+		}
 		return Matrix<T, 4, 4>(
 				r[0][0] * l[0][0] + r[0][1] * l[1][0] + r[0][2] * l[2][0] + r[0][3] * l[3][0],
 				r[0][0] * l[0][1] + r[0][1] * l[1][1] + r[0][2] * l[2][1] + r[0][3] * l[3][1],
@@ -358,18 +536,46 @@ namespace X
 	template<class T, uint32 R, uint32 C>
 	constexpr Matrix<T, R, C> operator*(Matrix<T, R, C> const& l, T const& r) noexcept
 	{
-		return Matrix<T, R, C>(l.v * Vector<T, C>(r));
+		return Matrix<T, R, C>(l.v * Vector<T, R>(r));
 	}
 	template<class T, uint32 R, uint32 C>
 	constexpr Matrix<T, R, C> operator*(T const& l, Matrix<T, R, C> const& r) noexcept
 	{
-		return Matrix<T, R, C>(Vector<T, C>(l) * r.v);
+		return Matrix<T, R, C>(Vector<T, R>(l) * r.v);
 	}
 
 	template<class T, uint32 R, uint32 C>
 	constexpr Matrix<T, R, C> operator/(Matrix<T, R, C> const& l, T const& r) noexcept
 	{
-		return Matrix<T, R, C>(l.v * Vector<T, C>(T(1) / r));
+		return Matrix<T, R, C>(l.v * Vector<T, R>(T(1) / r));
+	}
+
+	namespace Detail
+	{
+		// Columns are built in place, a 3x3 or 4x4 result can't be assigned member wise in a constant expression.
+		template <class T, uint32 R, uint32 K, uint32 C, uint32... Cs>
+		constexpr Matrix<T, R, C> MultiplyColumns(Matrix<T, R, K> const& l, Matrix<T, K, C> const& r, std::integer_sequence<uint32, Cs...>) noexcept
+		{
+			return Matrix<T, R, C>(Vector<Vector<T, R>, C>((l * r.v[Cs])...));
+		}
+	}
+
+	// Generic product, the 3x3 and 4x4 overloads above are preferred for those sizes.
+	template <class T, uint32 R, uint32 K, uint32 C>
+	constexpr Matrix<T, R, C> operator*(Matrix<T, R, K> const& l, Matrix<T, K, C> const& r) noexcept
+	{
+		return Detail::MultiplyColumns(l, r, std::make_integer_sequence<uint32, C>());
+	}
+
+	template <class T, uint32 R, uint32 C>
+	constexpr Vector<T, R> operator*(Matrix<T, R, C> const& l, Vector<T, C> const& r) noexcept
+	{
+		Vector<T, R> result = l.v[0] * r.v[0];
+		Detail::Unroll<C - 1>([&result, &l, &r](uint32 c)
+		{
+			result += l.v[c + 1] * r.v[c + 1];
+		});
+		return result;
 	}
 
 	template<class T, uint32 R, uint32 C>
@@ -389,5 +595,7 @@ namespace X
 	using M33F64 = Matrix<float64, 3, 3>;
 	using M44F32 = Matrix<float32, 4, 4>;
 	using M44F64 = Matrix<float64, 4, 4>;
+	using M66F32 = Matrix<float32, 6, 6>;
+	using M66F64 = Matrix<float64, 6, 6>;
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Math/Vector.h"
+#include <cmath>
 
 namespace X
 {
@@ -116,6 +117,58 @@ namespace X
 	template <typename T>
 	constexpr bool operator!=(Quaternion<T> const& l, Quaternion<T> const& r) noexcept { return l.v[0] != r.v[0] || l.v[1] != r.v[1] || l.v[2] != r.v[2] || l.v[3] != r.v[3]; }
 
+	template <typename T>
+	constexpr T Dot(Quaternion<T> const& l, Quaternion<T> const& r) noexcept { return l.v[0] * r.v[0] + l.v[1] * r.v[1] + l.v[2] * r.v[2] + l.v[3] * r.v[3]; }
+
+	/*
+	*	Interpolations below take the shorter arc, from and to must be normalized.
+	*/
+
+	// Normalized linear interpolation, angular speed is not constant.
+	template <typename T>
+	Quaternion<T> Nlerp(Quaternion<T> const& from, Quaternion<T> const& to, T const& t) noexcept
+	{
+		T const sign = Dot(from, to) < T(0) ? T(-1) : T(1);
+		return (from * (T(1) - t) + to * (sign * t)).Normalized();
+	}
+
+	// Spherical linear interpolation.
+	template <typename T>
+	Quaternion<T> Slerp(Quaternion<T> const& from, Quaternion<T> const& to, T const& t) noexcept
+	{
+		T cosTheta = Dot(from, to);
+		T sign = T(1);
+		if (cosTheta < T(0))
+		{
+			cosTheta = -cosTheta;
+			sign = T(-1);
+		}
+
+		// nearly the same rotation, sin(theta) is too small to divide.
+		if (cosTheta > T(0.9995))
+		{
+			return Nlerp(from, to, t);
+		}
+
+		T const theta = std::acos(cosTheta);
+		T const inverseSinTheta = T(1) / std::sin(theta);
+		return from * (std::sin((T(1) - t) * theta) * inverseSinTheta) + to * (sign * std::sin(t * theta) * inverseSinTheta);
+	}
+
+	/*
+	*	Nlerp with t corrected by a fitted polynomial, close to Slerp at a fraction of the cost.
+	*	see 'Approximating slerp', Arseny Kapoulkine.
+	*/
+	template <typename T>
+	Quaternion<T> SlerpFast(Quaternion<T> const& from, Quaternion<T> const& to, T const& t) noexcept
+	{
+		T const d = std::abs(Dot(from, to));
+		T const a = T(1.0904) + d * (T(-3.2452) + d * (T(3.55645) - d * T(1.43519)));
+		T const b = T(0.848013) + d * (T(-1.06021) + d * T(0.215638));
+		T const k = a * (t - T(0.5)) * (t - T(0.5)) + b;
+		return Nlerp(from, to, t + t * (t - T(0.5)) * (t - T(1)) * k);
+	}
+
 	using QF32 = Quaternion<float32>;
 	using QF64 = Quaternion<float64>;
 }
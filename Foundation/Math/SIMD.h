@@ -0,0 +1,595 @@
+#pragma once
+#include "Core/BasicType.h"
+#include "Core/Utility.h"
+#include <cmath>
+#include <type_traits>
+
+/*
+*	Opt-in SIMD backend.
+*	Enabled by compiler flags (-msse4.1, -mavx2, /arch:AVX, /arch:AVX2), or by defining X_SIMD_SSE41 / X_SIMD_AVX2 before inclusion.
+*	Define X_SIMD_DISABLE to force the scalar path.
+*/
+#if defined(X_SIMD_DISABLE)
+#undef X_SIMD_SSE41
+#undef X_SIMD_AVX2
+#undef X_SIMD_FMA
+#else
+#if !defined(X_SIMD_AVX2) && defined(__AVX2__)
+#define X_SIMD_AVX2
+#endif
+#if !defined(X_SIMD_SSE41) && (defined(X_SIMD_AVX2) || defined(__AVX__) || defined(__SSE4_1__))
+#define X_SIMD_SSE41
+#endif
+#if !defined(X_SIMD_FMA) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define X_SIMD_FMA
+#endif
+#endif
+
+// Vector and Matrix pick the SIMD path with IsConstantEvaluated(), without the builtin it would never be taken.
+#if defined(X_SIMD_SSE41) && !defined(X_HAS_CONSTANT_EVALUATED)
+#error "The SIMD backend needs IsConstantEvaluated() support (Visual Studio 2019 16.5, GCC 9, Clang 9 or later), define X_SIMD_DISABLE for older compilers."
+#endif
+
+#if defined(X_SIMD_SSE41)
+#include <immintrin.h>
+#endif
+
+namespace X
+{
+	namespace SIMD
+	{
+		// Lane count of the widest enabled float32 register.
+#if defined(X_SIMD_AVX2)
+		constexpr uint32 Width = 8;
+#elif defined(X_SIMD_SSE41)
+		constexpr uint32 Width = 4;
+#else
+		constexpr uint32 Width = 1;
+#endif
+
+		template <class T, uint32 N> // is a class due to template function cannot be partially specialized.
+		struct VectorHelper
+		{
+			static constexpr bool Enabled = false;
+		};
+
+		template <class T, uint32 R, uint32 C>
+		struct MatrixHelper
+		{
+			static constexpr bool Enabled = false;
+		};
+
+		/*
+		*	Register of Width elements, used by the batched kernels working on SoA streams.
+		*	Pointers passed to Load/Store must be aligned to Alignment.
+		*	ScalarPack is the one lane fallback, Pack<T> is the widest register available for T.
+		*/
+		template <class T>
+		struct ScalarPack
+		{
+			using Type = T;
+			static constexpr uint32 Width = 1;
+			static constexpr uint32 Alignment = alignof(T);
+
+			static Type Load(T const* p) noexcept { return *p; }
+			static void Store(T* p, Type v) noexcept { *p = v; }
+			static Type Set(T v) noexcept { return v; }
+
+			static Type Add(Type l, Type r) noexcept { return l + r; }
+			static Type Sub(Type l, Type r) noexcept { return l - r; }
+			static Type Mul(Type l, Type r) noexcept { return l * r; }
+			static Type Div(Type l, Type r) noexcept { return l / r; }
+			static Type MulAdd(Type l, Type r, Type a) noexcept { return l * r + a; }
+			static Type MulSub(Type l, Type r, Type a) noexcept { return l * r - a; }
+			static Type Min(Type l, Type r) noexcept { return r < l ? r : l; }
+			static Type Max(Type l, Type r) noexcept { return l < r ? r : l; }
+			static Type Abs(Type v) noexcept { return std::abs(v); }
+			// magnitude of m with the sign of s.
+			static Type CopySign(Type m, Type s) noexcept { return std::copysign(m, s); }
+			static Type Sqrt(Type v) noexcept { return std::sqrt(v); }
+			static Type Reciprocal(Type v) noexcept { return T(1) / v; }
+			static Type ReciprocalFast(Type v) noexcept { return T(1) / v; }
+			// bit i set when l <= r in lane i.
+			static uint32 MaskLessEqual(Type l, Type r) noexcept { return l <= r ? 1 : 0; }
+		};
+
+		template <class T>
+		struct Pack : ScalarPack<T> {};
+
+		/*
+		*	Bit set words, Words uint64 per register. Pointers passed to Load/Store must be aligned to Alignment.
+		*	ContainsAll(l, r) is true if every bit of r is in l.
+		*/
+		struct ScalarBitPack
+		{
+			using Type = uint64;
+			static constexpr uint32 Words = 1;
+			static constexpr uint32 Alignment = alignof(uint64);
+
+			static Type Load(uint64 const* p) noexcept { return *p; }
+			static void Store(uint64* p, Type v) noexcept { *p = v; }
+
+			static Type Or(Type l, Type r) noexcept { return l | r; }
+			static Type And(Type l, Type r) noexcept { return l & r; }
+			static Type AndNot(Type l, Type r) noexcept { return l & ~r; }
+			static Type Xor(Type l, Type r) noexcept { return l ^ r; }
+			static bool IsZero(Type v) noexcept { return v == 0; }
+			static bool ContainsAll(Type l, Type r) noexcept { return (r & ~l) == 0; }
+			static bool Intersects(Type l, Type r) noexcept { return (l & r) != 0; }
+		};
+
+		// Pack of exactly W lanes, or a narrower one to loop W / Width times.
+		template <class T, uint32 W>
+		struct PackOfWidth
+		{
+			using Type = ScalarPack<T>;
+		};
+
+#if defined(X_SIMD_SSE41)
+
+		inline __m128 Load4(float32 const v[4]) noexcept { return _mm_loadu_ps(v); }
+		inline void Store4(float32 out[4], __m128 v) noexcept { _mm_storeu_ps(out, v); }
+
+		// w lane is 0.
+		inline __m128 Load3(float32 const v[3]) noexcept
+		{
+			__m128 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(v)));
+			return _mm_movelh_ps(xy, _mm_load_ss(v + 2));
+		}
+		inline void Store3(float32 out[3], __m128 v) noexcept
+		{
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_castps_si128(v));
+			_mm_store_ss(out + 2, _mm_movehl_ps(v, v));
+		}
+
+		// Lane i of the result is lane Ii of v, a single shufps.
+		template <uint32 I0, uint32 I1, uint32 I2, uint32 I3>
+		inline __m128 Shuffle(__m128 v) noexcept
+		{
+			static_assert(I0 < 4 && I1 < 4 && I2 < 4 && I3 < 4, "Shuffle lanes are 0 to 3.");
+			return _mm_shuffle_ps(v, v, _MM_SHUFFLE(I3, I2, I1, I0));
+		}
+
+		/*
+		*	Converts 4 consecutive 3 component vectors (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) to x, y, z registers, and back.
+		*/
+		inline void Deinterleave3(float32 const p[12], __m128& x, __m128& y, __m128& z) noexcept
+		{
+			__m128 a = _mm_loadu_ps(p);
+			__m128 b = _mm_loadu_ps(p + 4);
+			__m128 c = _mm_loadu_ps(p + 8);
+			__m128 tx = _mm_blend_ps(_mm_blend_ps(a, b, 0x4), c, 0x2);
+			__m128 ty = _mm_blend_ps(_mm_blend_ps(a, b, 0x9), c, 0x4);
+			__m128 tz = _mm_blend_ps(_mm_blend_ps(a, b, 0x2), c, 0x9);
+			x = _mm_shuffle_ps(tx, tx, _MM_SHUFFLE(1, 2, 3, 0));
+			y = _mm_shuffle_ps(ty, ty, _MM_SHUFFLE(2, 3, 0, 1));
+			z = _mm_shuffle_ps(tz, tz, _MM_SHUFFLE(3, 0, 1, 2));
+		}
+		inline void Interleave3(float32 p[12], __m128 x, __m128 y, __m128 z) noexcept
+		{
+			__m128 tx = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 2, 3, 0));
+			__m128 ty = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1));
+			__m128 tz = _mm_shuffle_ps(z, z, _MM_SHUFFLE(3, 0, 1, 2));
+			_mm_storeu_ps(p, _mm_blend_ps(_mm_blend_ps(tx, ty, 0x2), tz, 0x4));
+			_mm_storeu_ps(p + 4, _mm_blend_ps(_mm_blend_ps(ty, tz, 0x2), tx, 0x4));
+			_mm_storeu_ps(p + 8, _mm_blend_ps(_mm_blend_ps(tz, tx, 0x2), ty, 0x4));
+		}
+
+		// Sum of the 4 lanes in every lane, two shuffles and adds instead of a slow dpps.
+		inline __m128 Sum4(__m128 v) noexcept
+		{
+			__m128 const pairs = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_add_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2)));
+		}
+
+		// l * r + a
+		inline __m128 MulAdd(__m128 l, __m128 r, __m128 a) noexcept
+		{
+#if defined(X_SIMD_FMA)
+			return _mm_fmadd_ps(l, r, a);
+#else
+			return _mm_add_ps(_mm_mul_ps(l, r), a);
+#endif
+		}
+
+		// l * r - a
+		inline __m128 MulSub(__m128 l, __m128 r, __m128 a) noexcept
+		{
+#if defined(X_SIMD_FMA)
+			return _mm_fmsub_ps(l, r, a);
+#else
+			return _mm_sub_ps(_mm_mul_ps(l, r), a);
+#endif
+		}
+
+#if defined(X_SIMD_AVX2)
+		inline __m256 MulAdd(__m256 l, __m256 r, __m256 a) noexcept
+		{
+#if defined(X_SIMD_FMA)
+			return _mm256_fmadd_ps(l, r, a);
+#else
+			return _mm256_add_ps(_mm256_mul_ps(l, r), a);
+#endif
+		}
+
+		inline __m256 MulSub(__m256 l, __m256 r, __m256 a) noexcept
+		{
+#if defined(X_SIMD_FMA)
+			return _mm256_fmsub_ps(l, r, a);
+#else
+			return _mm256_sub_ps(_mm256_mul_ps(l, r), a);
+#endif
+		}
+#endif // X_SIMD_AVX2
+
+		struct U64x2
+		{
+			using Type = __m128i;
+			static constexpr uint32 Words = 2;
+			static constexpr uint32 Alignment = 16;
+
+			static Type Load(uint64 const* p) noexcept { return _mm_load_si128(reinterpret_cast<__m128i const*>(p)); }
+			static void Store(uint64* p, Type v) noexcept { _mm_store_si128(reinterpret_cast<__m128i*>(p), v); }
+
+			static Type Or(Type l, Type r) noexcept { return _mm_or_si128(l, r); }
+			static Type And(Type l, Type r) noexcept { return _mm_and_si128(l, r); }
+			static Type AndNot(Type l, Type r) noexcept { return _mm_andnot_si128(r, l); }
+			static Type Xor(Type l, Type r) noexcept { return _mm_xor_si128(l, r); }
+			static bool IsZero(Type v) noexcept { return _mm_testz_si128(v, v) != 0; }
+			static bool ContainsAll(Type l, Type r) noexcept { return _mm_testc_si128(l, r) != 0; }
+			static bool Intersects(Type l, Type r) noexcept { return _mm_testz_si128(l, r) == 0; }
+		};
+
+		struct F32x4
+		{
+			using Type = __m128;
+			static constexpr uint32 Width = 4;
+			static constexpr uint32 Alignment = 16;
+
+			static Type Load(float32 const* p) noexcept { return _mm_load_ps(p); }
+			static void Store(float32* p, Type v) noexcept { _mm_store_ps(p, v); }
+			static Type Set(float32 v) noexcept { return _mm_set1_ps(v); }
+
+			static Type Add(Type l, Type r) noexcept { return _mm_add_ps(l, r); }
+			static Type Sub(Type l, Type r) noexcept { return _mm_sub_ps(l, r); }
+			static Type Mul(Type l, Type r) noexcept { return _mm_mul_ps(l, r); }
+			static Type Div(Type l, Type r) noexcept { return _mm_div_ps(l, r); }
+			static Type MulAdd(Type l, Type r, Type a) noexcept { return SIMD::MulAdd(l, r, a); }
+			static Type MulSub(Type l, Type r, Type a) noexcept { return SIMD::MulSub(l, r, a); }
+			static Type Min(Type l, Type r) noexcept { return _mm_min_ps(l, r); }
+			static Type Max(Type l, Type r) noexcept { return _mm_max_ps(l, r); }
+			static Type Abs(Type v) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+			static Type CopySign(Type m, Type s) noexcept { Type const sign = _mm_set1_ps(-0.0f); return _mm_or_ps(_mm_andnot_ps(sign, m), _mm_and_ps(sign, s)); }
+			static Type Sqrt(Type v) noexcept { return _mm_sqrt_ps(v); }
+			static Type Reciprocal(Type v) noexcept { return _mm_div_ps(_mm_set1_ps(1.0f), v); }
+			// rcpps refined by one Newton-Raphson step, about 22 bits of precision.
+			static Type ReciprocalFast(Type v) noexcept { Type r = _mm_rcp_ps(v); return _mm_mul_ps(r, SIMD::MulAdd(_mm_mul_ps(v, r), _mm_set1_ps(-1.0f), _mm_set1_ps(2.0f))); }
+			static uint32 MaskLessEqual(Type l, Type r) noexcept { return static_cast<uint32>(_mm_movemask_ps(_mm_cmple_ps(l, r))); }
+		};
+
+		template <>
+		struct PackOfWidth<float32, 4>
+		{
+			using Type = F32x4;
+		};
+
+#if defined(X_SIMD_AVX2)
+		struct F32x8
+		{
+			using Type = __m256;
+			static constexpr uint32 Width = 8;
+			static constexpr uint32 Alignment = 32;
+
+			static Type Load(float32 const* p) noexcept { return _mm256_load_ps(p); }
+			static void Store(float32* p, Type v) noexcept { _mm256_store_ps(p, v); }
+			static Type Set(float32 v) noexcept { return _mm256_set1_ps(v); }
+
+			static Type Add(Type l, Type r) noexcept { return _mm256_add_ps(l, r); }
+			static Type Sub(Type l, Type r) noexcept { return _mm256_sub_ps(l, r); }
+			static Type Mul(Type l, Type r) noexcept { return _mm256_mul_ps(l, r); }
+			static Type Div(Type l, Type r) noexcept { return _mm256_div_ps(l, r); }
+			static Type MulAdd(Type l, Type r, Type a) noexcept { return SIMD::MulAdd(l, r, a); }
+			static Type MulSub(Type l, Type r, Type a) noexcept { return SIMD::MulSub(l, r, a); }
+			static Type Min(Type l, Type r) noexcept { return _mm256_min_ps(l, r); }
+			static Type Max(Type l, Type r) noexcept { return _mm256_max_ps(l, r); }
+			static Type Abs(Type v) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+			static Type CopySign(Type m, Type s) noexcept { Type const sign = _mm256_set1_ps(-0.0f); return _mm256_or_ps(_mm256_andnot_ps(sign, m), _mm256_and_ps(sign, s)); }
+			static Type Sqrt(Type v) noexcept { return _mm256_sqrt_ps(v); }
+			static Type Reciprocal(Type v) noexcept { return _mm256_div_ps(_mm256_set1_ps(1.0f), v); }
+			// rcpps refined by one Newton-Raphson step, about 22 bits of precision.
+			static Type ReciprocalFast(Type v) noexcept { Type r = _mm256_rcp_ps(v); return _mm256_mul_ps(r, SIMD::MulAdd(_mm256_mul_ps(v, r), _mm256_set1_ps(-1.0f), _mm256_set1_ps(2.0f))); }
+			static uint32 MaskLessEqual(Type l, Type r) noexcept { return static_cast<uint32>(_mm256_movemask_ps(_mm256_cmp_ps(l, r, _CMP_LE_OQ))); }
+		};
+
+		struct U64x4
+		{
+			using Type = __m256i;
+			static constexpr uint32 Words = 4;
+			static constexpr uint32 Alignment = 32;
+
+			static Type Load(uint64 const* p) noexcept { return _mm256_load_si256(reinterpret_cast<__m256i const*>(p)); }
+			static void Store(uint64* p, Type v) noexcept { _mm256_store_si256(reinterpret_cast<__m256i*>(p), v); }
+
+			static Type Or(Type l, Type r) noexcept { return _mm256_or_si256(l, r); }
+			static Type And(Type l, Type r) noexcept { return _mm256_and_si256(l, r); }
+			static Type AndNot(Type l, Type r) noexcept { return _mm256_andnot_si256(r, l); }
+			static Type Xor(Type l, Type r) noexcept { return _mm256_xor_si256(l, r); }
+			static bool IsZero(Type v) noexcept { return _mm256_testz_si256(v, v) != 0; }
+			static bool ContainsAll(Type l, Type r) noexcept { return _mm256_testc_si256(l, r) != 0; }
+			static bool Intersects(Type l, Type r) noexcept { return _mm256_testz_si256(l, r) == 0; }
+		};
+
+		template <>
+		struct Pack<float32> : F32x8 {};
+
+		template <>
+		struct PackOfWidth<float32, 8>
+		{
+			using Type = F32x8;
+		};
+#else
+		template <>
+		struct Pack<float32> : F32x4 {};
+
+		template <>
+		struct PackOfWidth<float32, 8>
+		{
+			using Type = F32x4;
+		};
+#endif // X_SIMD_AVX2
+
+		template <>
+		struct VectorHelper<float32, 4>
+		{
+			static constexpr bool Enabled = true;
+
+			static void Add(float32 out[4], float32 const l[4], float32 const r[4]) noexcept { Store4(out, _mm_add_ps(Load4(l), Load4(r))); }
+			static void Sub(float32 out[4], float32 const l[4], float32 const r[4]) noexcept { Store4(out, _mm_sub_ps(Load4(l), Load4(r))); }
+			static void Mul(float32 out[4], float32 const l[4], float32 const r[4]) noexcept { Store4(out, _mm_mul_ps(Load4(l), Load4(r))); }
+			static void Mul(float32 out[4], float32 const l[4], float32 r) noexcept { Store4(out, _mm_mul_ps(Load4(l), _mm_set1_ps(r))); }
+			static void Div(float32 out[4], float32 const l[4], float32 const r[4]) noexcept { Store4(out, _mm_div_ps(Load4(l), Load4(r))); }
+			static void Div(float32 out[4], float32 const l[4], float32 r) noexcept { Store4(out, _mm_div_ps(Load4(l), _mm_set1_ps(r))); }
+
+			static float32 Dot(float32 const l[4], float32 const r[4]) noexcept { return _mm_cvtss_f32(Sum4(_mm_mul_ps(Load4(l), Load4(r)))); }
+			static float32 Length(float32 const v[4]) noexcept { __m128 x = Load4(v); return _mm_cvtss_f32(_mm_sqrt_ss(Sum4(_mm_mul_ps(x, x)))); }
+			static void Normalize(float32 out[4], float32 const v[4]) noexcept { __m128 x = Load4(v); Store4(out, _mm_div_ps(x, _mm_sqrt_ps(Sum4(_mm_mul_ps(x, x))))); }
+
+			template <uint32 I0, uint32 I1, uint32 I2, uint32 I3>
+			static void Swizzle(float32 out[4], float32 const v[4]) noexcept { Store4(out, Shuffle<I0, I1, I2, I3>(Load4(v))); }
+			template <uint32 I0, uint32 I1, uint32 I2>
+			static void Swizzle(float32 out[3], float32 const v[4]) noexcept { Store3(out, Shuffle<I0, I1, I2, 3>(Load4(v))); }
+		};
+
+		template <>
+		struct VectorHelper<float32, 3>
+		{
+			static constexpr bool Enabled = true;
+
+			static void Add(float32 out[3], float32 const l[3], float32 const r[3]) noexcept { Store3(out, _mm_add_ps(Load3(l), Load3(r))); }
+			static void Sub(float32 out[3], float32 const l[3], float32 const r[3]) noexcept { Store3(out, _mm_sub_ps(Load3(l), Load3(r))); }
+			static void Mul(float32 out[3], float32 const l[3], float32 const r[3]) noexcept { Store3(out, _mm_mul_ps(Load3(l), Load3(r))); }
+			static void Mul(float32 out[3], float32 const l[3], float32 r) noexcept { Store3(out, _mm_mul_ps(Load3(l), _mm_set1_ps(r))); }
+			// w lane of r is 1 so the unused lane never divides by zero.
+			static void Div(float32 out[3], float32 const l[3], float32 const r[3]) noexcept { Store3(out, _mm_div_ps(Load3(l), _mm_insert_ps(Load3(r), _mm_set_ss(1.0f), 0x30))); }
+			static void Div(float32 out[3], float32 const l[3], float32 r) noexcept { Store3(out, _mm_div_ps(Load3(l), _mm_set1_ps(r))); }
+
+			// the w lane of Load3 is 0, so it adds nothing to the sums.
+			static float32 Dot(float32 const l[3], float32 const r[3]) noexcept { return _mm_cvtss_f32(Sum4(_mm_mul_ps(Load3(l), Load3(r)))); }
+			static float32 Length(float32 const v[3]) noexcept { __m128 x = Load3(v); return _mm_cvtss_f32(_mm_sqrt_ss(Sum4(_mm_mul_ps(x, x)))); }
+			static void Normalize(float32 out[3], float32 const v[3]) noexcept { __m128 x = Load3(v); Store3(out, _mm_div_ps(x, _mm_sqrt_ps(Sum4(_mm_mul_ps(x, x))))); }
+
+			template <uint32 I0, uint32 I1, uint32 I2, uint32 I3>
+			static void Swizzle(float32 out[4], float32 const v[3]) noexcept { Store4(out, Shuffle<I0, I1, I2, I3>(Load3(v))); }
+			template <uint32 I0, uint32 I1, uint32 I2>
+			static void Swizzle(float32 out[3], float32 const v[3]) noexcept { Store3(out, Shuffle<I0, I1, I2, 3>(Load3(v))); }
+
+			static void Cross(float32 out[3], float32 const l[3], float32 const r[3]) noexcept
+			{
+				__m128 a = Load3(l);
+				__m128 b = Load3(r);
+				__m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+				__m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+				__m128 c = MulSub(a, b_yzx, _mm_mul_ps(a_yzx, b));
+				Store3(out, _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+			}
+		};
+
+		/*
+		*	Column major 4x4 float matrix, columns are loaded to registers.
+		*/
+		template <>
+		struct MatrixHelper<float32, 4, 4>
+		{
+			static constexpr bool Enabled = true;
+
+			// out = l * r, out may alias l or r.
+			static void Multiply(float32 out[16], float32 const l[16], float32 const r[16]) noexcept
+			{
+				// result column j = sum(l column k * r[j][k])
+#if defined(X_SIMD_AVX2)
+				__m256 const l0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l));
+				__m256 const l1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 4));
+				__m256 const l2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 8));
+				__m256 const l3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 12));
+				__m256 const r01 = _mm256_loadu_ps(r);
+				__m256 const r23 = _mm256_loadu_ps(r + 8);
+				__m256 o01 = _mm256_mul_ps(l0, _mm256_shuffle_ps(r01, r01, _MM_SHUFFLE(0, 0, 0, 0)));
+				__m256 o23 = _mm256_mul_ps(l0, _mm256_shuffle_ps(r23, r23, _MM_SHUFFLE(0, 0, 0, 0)));
+				o01 = MulAdd(l1, _mm256_shuffle_ps(r01, r01, _MM_SHUFFLE(1, 1, 1, 1)), o01);
+				o23 = MulAdd(l1, _mm256_shuffle_ps(r23, r23, _MM_SHUFFLE(1, 1, 1, 1)), o23);
+				o01 = MulAdd(l2, _mm256_shuffle_ps(r01, r01, _MM_SHUFFLE(2, 2, 2, 2)), o01);
+				o23 = MulAdd(l2, _mm256_shuffle_ps(r23, r23, _MM_SHUFFLE(2, 2, 2, 2)), o23);
+				o01 = MulAdd(l3, _mm256_shuffle_ps(r01, r01, _MM_SHUFFLE(3, 3, 3, 3)), o01);
+				o23 = MulAdd(l3, _mm256_shuffle_ps(r23, r23, _MM_SHUFFLE(3, 3, 3, 3)), o23);
+				_mm256_storeu_ps(out, o01);
+				_mm256_storeu_ps(out + 8, o23);
+#else
+				__m128 const l0 = Load4(l), l1 = Load4(l + 4), l2 = Load4(l + 8), l3 = Load4(l + 12);
+				__m128 o[4];
+				for (uint32 j = 0; j < 4; ++j)
+				{
+					__m128 const c = Load4(r + j * 4);
+					o[j] = _mm_mul_ps(l0, _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0)));
+					o[j] = MulAdd(l1, _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1)), o[j]);
+					o[j] = MulAdd(l2, _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2)), o[j]);
+					o[j] = MulAdd(l3, _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3)), o[j]);
+				}
+				Store4(out, o[0]);
+				Store4(out + 4, o[1]);
+				Store4(out + 8, o[2]);
+				Store4(out + 12, o[3]);
+#endif
+			}
+
+			static void Transpose(float32 out[16], float32 const m[16]) noexcept
+			{
+				__m128 c0 = Load4(m), c1 = Load4(m + 4), c2 = Load4(m + 8), c3 = Load4(m + 12);
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				Store4(out, c0);
+				Store4(out + 4, c1);
+				Store4(out + 8, c2);
+				Store4(out + 12, c3);
+			}
+
+			/*
+			*	General inverse by 2x2 block matrices, see 'Fast 4x4 Matrix Inverse with SSE SIMD, Explained', Eric Zhang.
+			*	Written for rows, works for columns since inverse(transpose(M)) = transpose(inverse(M)).
+			*	@return: determinant, out is not usable if it is 0.
+			*/
+			static float32 Inverse(float32 out[16], float32 const m[16]) noexcept
+			{
+				__m128 const c0 = Load4(m), c1 = Load4(m + 4), c2 = Load4(m + 8), c3 = Load4(m + 12);
+
+				__m128 const a = _mm_movelh_ps(c0, c1);
+				__m128 const b = _mm_movehl_ps(c1, c0);
+				__m128 const c = _mm_movelh_ps(c2, c3);
+				__m128 const d = _mm_movehl_ps(c3, c2);
+
+				// (|A|, |B|, |C|, |D|)
+				__m128 const detSub = _mm_sub_ps(
+					_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+					_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+				__m128 const detA = Swizzle<0, 0, 0, 0>(detSub);
+				__m128 const detB = Swizzle<1, 1, 1, 1>(detSub);
+				__m128 const detC = Swizzle<2, 2, 2, 2>(detSub);
+				__m128 const detD = Swizzle<3, 3, 3, 3>(detSub);
+
+				__m128 const dc = Mat2AdjMul(d, c);
+				__m128 const ab = Mat2AdjMul(a, b);
+				__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, dc));
+				__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, ab));
+				__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, ab));
+				__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, dc));
+
+				__m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+				__m128 tr = _mm_mul_ps(ab, Swizzle<0, 2, 1, 3>(dc));
+				tr = _mm_hadd_ps(tr, tr);
+				tr = _mm_hadd_ps(tr, tr);
+				detM = _mm_sub_ps(detM, tr);
+
+				float32 const determinant = _mm_cvtss_f32(detM);
+				if (determinant == 0.0f)
+				{
+					return determinant;
+				}
+
+				__m128 const inverseDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+				x = _mm_mul_ps(x, inverseDetM);
+				y = _mm_mul_ps(y, inverseDetM);
+				z = _mm_mul_ps(z, inverseDetM);
+				w = _mm_mul_ps(w, inverseDetM);
+
+				Store4(out, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+				Store4(out + 4, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+				Store4(out + 8, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+				Store4(out + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+				return determinant;
+			}
+
+			/*
+			*	Inverse of a matrix with last row (0, 0, 0, 1), inverse of the 3x3 part by cross products.
+			*	@return: determinant of the 3x3 part, out is not usable if it is 0.
+			*/
+			static float32 AffineInverse(float32 out[16], float32 const m[16]) noexcept
+			{
+				__m128 const c0 = Load4(m), c1 = Load4(m + 4), c2 = Load4(m + 8), t = Load4(m + 12);
+
+				// rows of the adjugate
+				__m128 r0 = Cross(c1, c2);
+				__m128 r1 = Cross(c2, c0);
+				__m128 r2 = Cross(c0, c1);
+				__m128 const det = _mm_dp_ps(c0, r0, 0x7F);
+
+				float32 const determinant = _mm_cvtss_f32(det);
+				if (determinant == 0.0f)
+				{
+					return determinant;
+				}
+
+				__m128 const inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+				r0 = _mm_mul_ps(r0, inverseDet);
+				r1 = _mm_mul_ps(r1, inverseDet);
+				r2 = _mm_mul_ps(r2, inverseDet);
+				__m128 r3 = _mm_setzero_ps();
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				StoreAffine(out, r0, r1, r2, t);
+				return determinant;
+			}
+
+			// Inverse of a matrix with orthonormal 3x3 part and last row (0, 0, 0, 1), only a transpose and a translation.
+			static void RigidInverse(float32 out[16], float32 const m[16]) noexcept
+			{
+				__m128 r0 = Load4(m), r1 = Load4(m + 4), r2 = Load4(m + 8), r3 = _mm_setzero_ps();
+				__m128 const t = Load4(m + 12);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				StoreAffine(out, r0, r1, r2, t);
+			}
+
+		private:
+			template <int X, int Y, int Z, int W>
+			static __m128 Swizzle(__m128 v) noexcept { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X)); }
+
+			// 2x2 matrices stored in one register, row major.
+			// A * B
+			static __m128 Mat2Mul(__m128 a, __m128 b) noexcept { return _mm_add_ps(_mm_mul_ps(a, Swizzle<0, 3, 0, 3>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b))); }
+			// adjugate(A) * B
+			static __m128 Mat2AdjMul(__m128 a, __m128 b) noexcept { return _mm_sub_ps(_mm_mul_ps(Swizzle<3, 3, 0, 0>(a), b), _mm_mul_ps(Swizzle<1, 1, 2, 2>(a), Swizzle<2, 3, 0, 1>(b))); }
+			// A * adjugate(B)
+			static __m128 Mat2MulAdj(__m128 a, __m128 b) noexcept { return _mm_sub_ps(_mm_mul_ps(a, Swizzle<3, 0, 3, 0>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b))); }
+
+			static __m128 Cross(__m128 a, __m128 b) noexcept
+			{
+				__m128 const c = MulSub(a, Swizzle<1, 2, 0, 3>(b), _mm_mul_ps(Swizzle<1, 2, 0, 3>(a), b));
+				return Swizzle<1, 2, 0, 3>(c);
+			}
+
+			// columns i0, i1, i2 of the inverse 3x3 part (w = 0), translation is -(inverse * t).
+			static void StoreAffine(float32 out[16], __m128 i0, __m128 i1, __m128 i2, __m128 t) noexcept
+			{
+				__m128 it = _mm_mul_ps(i0, Swizzle<0, 0, 0, 0>(t));
+				it = MulAdd(i1, Swizzle<1, 1, 1, 1>(t), it);
+				it = MulAdd(i2, Swizzle<2, 2, 2, 2>(t), it);
+				it = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), it);
+				Store4(out, i0);
+				Store4(out + 4, i1);
+				Store4(out + 8, i2);
+				Store4(out + 12, it);
+			}
+		};
+
+#endif // X_SIMD_SSE41
+
+		// Widest bit pack whose word count divides WordCount.
+		template <uint32 WordCount>
+		struct BitPackOf
+		{
+#if defined(X_SIMD_AVX2)
+			using Type = std::conditional_t<WordCount % 4 == 0, U64x4, std::conditional_t<WordCount % 2 == 0, U64x2, ScalarBitPack>>;
+#elif defined(X_SIMD_SSE41)
+			using Type = std::conditional_t<WordCount % 2 == 0, U64x2, ScalarBitPack>;
+#else
+			using Type = ScalarBitPack;
+#endif
+		};
+	}
+}
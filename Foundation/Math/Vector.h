@@ -1,7 +1,11 @@
 #pragma once
 #include "Core/BasicType.h"
 #include "Core/Utility.h"
+#include "Math/SIMD.h"
 #include <cassert>
+#include <cmath>
+#include <type_traits>
+#include <utility>
 
 
 namespace X
@@ -15,6 +19,173 @@ namespace X
 	template <class T, uint32 Count>
 	class Vector;
 
+	namespace Detail
+	{
+		template <uint32... Indices>
+		constexpr bool DistinctIndices() noexcept
+		{
+			uint32 const indices[] = { Indices... };
+			for (uint32 i = 0; i < sizeof...(Indices); ++i)
+			{
+				for (uint32 j = i + 1; j < sizeof...(Indices); ++j)
+				{
+					if (indices[i] == indices[j])
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		// f(i) for i in [0, N), unrolled at compile time.
+		template <class F, uint32... I>
+		constexpr void UnrollImpl(F&& f, std::integer_sequence<uint32, I...>)
+		{
+			(f(I), ...);
+		}
+
+		template <uint32 N, class F>
+		constexpr void Unroll(F&& f)
+		{
+			UnrollImpl(f, std::make_integer_sequence<uint32, N>());
+		}
+
+		// Vector of v[Indices]..., one shuffle on the SIMD backend for 3 and 4 component results.
+		template <class T, uint32 Count, uint32... Indices>
+		constexpr Vector<T, sizeof...(Indices)> Swizzle(T const* v) noexcept
+		{
+			static_assert(sizeof...(Indices) >= 1 && sizeof...(Indices) <= 4, "Swizzles have 1 to 4 components.");
+			static_assert(((Indices < Count) && ...), "Swizzle component out of range.");
+			if constexpr (SIMD::VectorHelper<T, Count>::Enabled && sizeof...(Indices) >= 3)
+			{
+				if (!IsConstantEvaluated())
+				{
+					Vector<T, sizeof...(Indices)> result{};
+					SIMD::VectorHelper<T, Count>::template Swizzle<Indices...>(result.v, v);
+					return result;
+				}
+			}
+			return Vector<T, sizeof...(Indices)>(v[Indices]...);
+		}
+	}
+
+	/*
+	*	Writable swizzle of a vector, from Vector::Ref<_X, _Z>(). Assigning writes the named components, reading gives the swizzled Vector.
+	*	Refers to the vector, so keep it in the expression it was made in.
+	*/
+	template <class T, uint32 Count, uint32... Indices>
+	class SwizzleRef
+	{
+		static_assert(Detail::DistinctIndices<Indices...>(), "Components of a written swizzle must be distinct.");
+
+	public:
+		using Value = Vector<T, sizeof...(Indices)>;
+
+		constexpr explicit SwizzleRef(T* v) noexcept : v(v) {}
+
+		SwizzleRef(SwizzleRef const&) = default;
+
+		constexpr SwizzleRef& operator=(Value const& r) noexcept
+		{
+			uint32 i = 0;
+			((v[Indices] = r.v[i++]), ...);
+			return *this;
+		}
+
+		constexpr SwizzleRef& operator=(SwizzleRef const& r) noexcept { return *this = Value(r); }
+
+		constexpr operator Value() const noexcept { return Detail::Swizzle<T, Count, Indices...>(v); }
+
+		constexpr SwizzleRef& operator+=(Value const& r) noexcept { return *this = Value(*this) + r; }
+		constexpr SwizzleRef& operator-=(Value const& r) noexcept { return *this = Value(*this) - r; }
+		constexpr SwizzleRef& operator*=(Value const& r) noexcept { return *this = Value(*this) * r; }
+		constexpr SwizzleRef& operator*=(T const& r) noexcept { return *this = Value(*this) * r; }
+		constexpr SwizzleRef& operator/=(Value const& r) noexcept { return *this = Value(*this) / r; }
+		constexpr SwizzleRef& operator/=(T const& r) noexcept { return *this = Value(*this) / r; }
+
+	private:
+		T* v;
+	};
+
+	/*
+	*	Vectors of any dimension, 1 to 4 are specialized with named components and SIMD paths.
+	*	Every operation is unrolled over the components at compile time, so the compiler can keep them in registers and vectorize.
+	*/
+	template <class T, uint32 N>
+	class Vector
+	{
+	public:
+		static constexpr uint32 Count = N;
+
+		static Vector const Zero;
+
+		T v[Count];
+
+		constexpr Vector() noexcept = default;
+
+		constexpr explicit Vector(T const& r) noexcept : Vector(r, std::make_integer_sequence<uint32, Count>()) {}
+
+		template <class... Args, class = std::enable_if_t<sizeof...(Args) == Count && Count != 1 && (std::is_convertible_v<Args const&, T> && ...)>>
+		constexpr Vector(Args const&... args) noexcept : v{ T(args)... } {}
+
+		template <class U>
+		constexpr explicit Vector(Vector<U, Count> const& r) noexcept : Vector(r, std::make_integer_sequence<uint32, Count>()) {}
+
+		constexpr T const& operator[](uint32 index) const noexcept { assert(index < Count); return v[index]; }
+		constexpr T& operator[](uint32 index) noexcept { assert(index < Count); return v[index]; }
+
+		template <class... Swizzles>
+		constexpr Vector<T, sizeof...(Swizzles)> _() const noexcept { return Detail::Swizzle<T, Count, Swizzles::Index...>(v); }
+		template <class... Swizzles>
+		constexpr SwizzleRef<T, Count, Swizzles::Index...> Ref() noexcept { return SwizzleRef<T, Count, Swizzles::Index...>(v); }
+
+		constexpr Vector const& operator+() const noexcept { return *this; }
+		constexpr Vector operator-() const noexcept { Vector result = *this; Detail::Unroll<Count>([&result](uint32 i) { result.v[i] = -result.v[i]; }); return result; }
+
+		constexpr Vector& operator+=(Vector const& r) noexcept { Detail::Unroll<Count>([this, &r](uint32 i) { v[i] += r.v[i]; }); return *this; }
+		constexpr Vector& operator-=(Vector const& r) noexcept { Detail::Unroll<Count>([this, &r](uint32 i) { v[i] -= r.v[i]; }); return *this; }
+		constexpr Vector& operator*=(Vector const& r) noexcept { Detail::Unroll<Count>([this, &r](uint32 i) { v[i] *= r.v[i]; }); return *this; }
+		constexpr Vector& operator*=(T const& r) noexcept { Detail::Unroll<Count>([this, &r](uint32 i) { v[i] *= r; }); return *this; }
+		constexpr Vector& operator/=(Vector const& r) noexcept { Detail::Unroll<Count>([this, &r](uint32 i) { v[i] /= r.v[i]; }); return *this; }
+		constexpr Vector& operator/=(T const& r) noexcept { Detail::Unroll<Count>([this, &r](uint32 i) { v[i] /= r; }); return *this; }
+
+		constexpr Vector Normalized() const noexcept { static_assert(std::is_floating_point_v<T>, "Normalized() for floating point types only."); return *this / Length(); }
+
+		constexpr T Length() const noexcept { static_assert(std::is_floating_point_v<T>, "Length() for floating point types only."); return std::sqrt(LengthSquared()); }
+
+		constexpr T LengthSquared() const noexcept { return Dot(*this, *this); }
+
+		T* Data() noexcept { return v; }
+		T const* Data() const noexcept { return v; }
+
+	private:
+		template <uint32... I>
+		constexpr Vector(T const& r, std::integer_sequence<uint32, I...>) noexcept : v{ (static_cast<void>(I), r)... } {}
+
+		template <class U, uint32... I>
+		constexpr Vector(Vector<U, Count> const& r, std::integer_sequence<uint32, I...>) noexcept : v{ T(r.v[I])... } {}
+	};
+
+	template <class T, uint32 N>
+	Vector<T, N> const Vector<T, N>::Zero = Vector(T(0));
+
+	namespace Detail
+	{
+		template <class T, uint32 N, uint32... I>
+		constexpr bool Equal(Vector<T, N> const& l, Vector<T, N> const& r, std::integer_sequence<uint32, I...>) noexcept { return ((l.v[I] == r.v[I]) && ...); }
+
+		template <class T, uint32 N, uint32... I>
+		constexpr T Dot(Vector<T, N> const& l, Vector<T, N> const& r, std::integer_sequence<uint32, I...>) noexcept { return ((l.v[I] * r.v[I]) + ...); }
+	}
+
+	template <class T, uint32 N>
+	constexpr bool operator==(Vector<T, N> const& l, Vector<T, N> const& r) noexcept { return Detail::Equal(l, r, std::make_integer_sequence<uint32, N>()); }
+	template <class T, uint32 N>
+	constexpr bool operator!=(Vector<T, N> const& l, Vector<T, N> const& r) noexcept { return !(l == r); }
+	template <class T, uint32 N>
+	constexpr T Dot(Vector<T, N> const& l, Vector<T, N> const& r) noexcept { return Detail::Dot(l, r, std::make_integer_sequence<uint32, N>()); }
+
 	template <class T>
 	class Vector<T, 1>
 	{
@@ -44,8 +215,12 @@ namespace X
 		constexpr T const& operator[](uint32 index) const noexcept { assert(index < Count); return v[index]; }
 		constexpr T& operator[](uint32 index) noexcept { assert(index < Count); return v[index]; }
 
-		template <class Swizzle0>
-		constexpr Vector<T, 1> _() { return Vector<T, 1>(v[Swizzle0::Index]); }
+		// Read swizzle, e.g. v._<_Z, _Y, _X>().
+		template <class... Swizzles>
+		constexpr Vector<T, sizeof...(Swizzles)> _() const noexcept { return Detail::Swizzle<T, Count, Swizzles::Index...>(v); }
+		// Write swizzle, e.g. v.Ref<_X, _Z>() = xz.
+		template <class... Swizzles>
+		constexpr SwizzleRef<T, Count, Swizzles::Index...> Ref() noexcept { return SwizzleRef<T, Count, Swizzles::Index...>(v); }
 
 		constexpr Vector const& operator+() const noexcept { return *this; }
 		constexpr Vector operator-() const noexcept { return Vector(-v[0]); }
@@ -114,10 +289,12 @@ namespace X
 		constexpr T const& operator[](uint32 index) const noexcept { assert(index < Count); return v[index]; }
 		constexpr T& operator[](uint32 index) noexcept { assert(index < Count); return v[index]; }
 
-		template <class Swizzle0>
-		constexpr Vector<T, 1> _() { return Vector<T, 1>(v[Swizzle0::Index]); }
-		template <class Swizzle0, class Swizzle1>
-		constexpr Vector<T, 2> _() { return Vector<T, 2>(v[Swizzle0::Index], v[Swizzle1::Index]); }
+		// Read swizzle, e.g. v._<_Z, _Y, _X>().
+		template <class... Swizzles>
+		constexpr Vector<T, sizeof...(Swizzles)> _() const noexcept { return Detail::Swizzle<T, Count, Swizzles::Index...>(v); }
+		// Write swizzle, e.g. v.Ref<_X, _Z>() = xz.
+		template <class... Swizzles>
+		constexpr SwizzleRef<T, Count, Swizzles::Index...> Ref() noexcept { return SwizzleRef<T, Count, Swizzles::Index...>(v); }
 
 
 		constexpr Vector const& operator+() const noexcept { return *this; }
@@ -155,6 +332,8 @@ namespace X
 	{
 	public:
 		static constexpr uint32 Count = 3;
+		// Runtime arithmetic goes through SIMD::VectorHelper, constant evaluation stays scalar.
+		static constexpr bool Accelerated = SIMD::VectorHelper<T, Count>::Enabled;
 
 		static Vector const Zero;
 
@@ -190,26 +369,26 @@ namespace X
 		constexpr T const& operator[](uint32 index) const noexcept { assert(index < Count); return v[index]; }
 		constexpr T& operator[](uint32 index) noexcept { assert(index < Count); return v[index]; }
 
-		template <class Swizzle0>
-		constexpr Vector<T, 1> _() { return Vector<T, 1>(v[Swizzle0::Index]); }
-		template <class Swizzle0, class Swizzle1>
-		constexpr Vector<T, 2> _() { return Vector<T, 2>(v[Swizzle0::Index], v[Swizzle1::Index]); }
-		template <class Swizzle0, class Swizzle1, class Swizzle2>
-		constexpr Vector<T, 3> _() { return Vector<T, 3>(v[Swizzle0::Index], v[Swizzle1::Index], v[Swizzle2::Index]); }
+		// Read swizzle, e.g. v._<_Z, _Y, _X>().
+		template <class... Swizzles>
+		constexpr Vector<T, sizeof...(Swizzles)> _() const noexcept { return Detail::Swizzle<T, Count, Swizzles::Index...>(v); }
+		// Write swizzle, e.g. v.Ref<_X, _Z>() = xz.
+		template <class... Swizzles>
+		constexpr SwizzleRef<T, Count, Swizzles::Index...> Ref() noexcept { return SwizzleRef<T, Count, Swizzles::Index...>(v); }
 
 		constexpr Vector const& operator+() const noexcept { return *this; }
 		constexpr Vector operator-() const noexcept { return Vector(-v[0], -v[1], -v[2]); }
 
-		constexpr Vector& operator+=(Vector const& r) noexcept { v[0] += r.v[0]; v[1] += r.v[1]; v[2] += r.v[2]; return *this; }
-		constexpr Vector& operator-=(Vector const& r) noexcept { v[0] -= r.v[0]; v[1] -= r.v[1]; v[2] -= r.v[2]; return *this; }
-		constexpr Vector& operator*=(Vector const& r) noexcept { v[0] *= r.v[0]; v[1] *= r.v[1]; v[2] *= r.v[2]; return *this; }
-		constexpr Vector& operator*=(T const& r) noexcept { v[0] *= r; v[1] *= r; v[2] *= r; return *this; }
-		constexpr Vector& operator/=(Vector const& r) noexcept { v[0] /= r.v[0]; v[1] /= r.v[1]; v[2] /= r.v[2]; return *this; }
-		constexpr Vector& operator/=(T const& r) noexcept { v[0] /= r; v[1] /= r; v[2] /= r; return *this; }
+		constexpr Vector& operator+=(Vector const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Add(v, v, r.v); return *this; } } v[0] += r.v[0]; v[1] += r.v[1]; v[2] += r.v[2]; return *this; }
+		constexpr Vector& operator-=(Vector const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Sub(v, v, r.v); return *this; } } v[0] -= r.v[0]; v[1] -= r.v[1]; v[2] -= r.v[2]; return *this; }
+		constexpr Vector& operator*=(Vector const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Mul(v, v, r.v); return *this; } } v[0] *= r.v[0]; v[1] *= r.v[1]; v[2] *= r.v[2]; return *this; }
+		constexpr Vector& operator*=(T const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Mul(v, v, r); return *this; } } v[0] *= r; v[1] *= r; v[2] *= r; return *this; }
+		constexpr Vector& operator/=(Vector const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Div(v, v, r.v); return *this; } } v[0] /= r.v[0]; v[1] /= r.v[1]; v[2] /= r.v[2]; return *this; }
+		constexpr Vector& operator/=(T const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Div(v, v, r); return *this; } } v[0] /= r; v[1] /= r; v[2] /= r; return *this; }
 
-		constexpr Vector Normalized() const noexcept { static_assert(std::is_floating_point_v<T>, "Normalized() for floating point types only."); return *this / Length(); }
+		constexpr Vector Normalized() const noexcept { static_assert(std::is_floating_point_v<T>, "Normalized() for floating point types only."); if constexpr (Accelerated) { if (!IsConstantEvaluated()) { Vector result = *this; SIMD::VectorHelper<T, Count>::Normalize(result.v, v); return result; } } return *this / Length(); }
 
-		constexpr T Length() const noexcept { static_assert(std::is_floating_point_v<T>, "Length() for floating point types only."); return std::sqrt(LengthSquared()); }
+		constexpr T Length() const noexcept { static_assert(std::is_floating_point_v<T>, "Length() for floating point types only."); if constexpr (Accelerated) { if (!IsConstantEvaluated()) { return SIMD::VectorHelper<T, Count>::Length(v); } } return std::sqrt(LengthSquared()); }
 
 		constexpr T LengthSquared() const noexcept { return Dot(*this, *this); }
 
@@ -225,15 +404,17 @@ namespace X
 	constexpr bool operator!=(Vector<T, 3> const& l, Vector<T, 3> const& r) noexcept { return l.v[0] != r.v[0] || l.v[1] != r.v[1] || l.v[2] != r.v[2]; }
 
 	template <class T>
-	constexpr T Dot(Vector<T, 3> const& l, Vector<T, 3> const& r) noexcept { return l.v[0] * r.v[0] + l.v[1] * r.v[1] + l.v[2] * r.v[2]; }
+	constexpr T Dot(Vector<T, 3> const& l, Vector<T, 3> const& r) noexcept { if constexpr (Vector<T, 3>::Accelerated) { if (!IsConstantEvaluated()) { return SIMD::VectorHelper<T, 3>::Dot(l.v, r.v); } } return l.v[0] * r.v[0] + l.v[1] * r.v[1] + l.v[2] * r.v[2]; }
 	template <class T>
-	constexpr Vector<T, 3> Cross(Vector<T, 3> const& l, Vector<T, 3> const& r) noexcept { return Vector<T, 3>(l.v[1] * r.v[2] - l.v[2] * r.v[1], l.v[2] * r.v[0] - l.v[0] * r.v[2], l.v[0] * r.v[1] - l.v[1] * r.v[0]); }
+	constexpr Vector<T, 3> Cross(Vector<T, 3> const& l, Vector<T, 3> const& r) noexcept { if constexpr (Vector<T, 3>::Accelerated) { if (!IsConstantEvaluated()) { Vector<T, 3> result = l; SIMD::VectorHelper<T, 3>::Cross(result.v, l.v, r.v); return result; } } return Vector<T, 3>(l.v[1] * r.v[2] - l.v[2] * r.v[1], l.v[2] * r.v[0] - l.v[0] * r.v[2], l.v[0] * r.v[1] - l.v[1] * r.v[0]); }
 
 	template <class T>
 	class Vector<T, 4>
 	{
 	public:
 		static constexpr uint32 Count = 4;
+		// Runtime arithmetic goes through SIMD::VectorHelper, constant evaluation stays scalar.
+		static constexpr bool Accelerated = SIMD::VectorHelper<T, Count>::Enabled;
 
 		static Vector const Zero;
 
@@ -276,28 +457,26 @@ namespace X
 		constexpr T const& operator[](uint32 index) const noexcept { assert(index < Count); return v[index]; }
 		constexpr T& operator[](uint32 index) noexcept { assert(index < Count); return v[index]; }
 
-		template <class Swizzle0>
-		constexpr Vector<T, 1> _() { return Vector<T, 1>(v[Swizzle0::Index]); }
-		template <class Swizzle0, class Swizzle1>
-		constexpr Vector<T, 2> _() { return Vector<T, 2>(v[Swizzle0::Index], v[Swizzle1::Index]); }
-		template <class Swizzle0, class Swizzle1, class Swizzle2>
-		constexpr Vector<T, 3> _() { return Vector<T, 3>(v[Swizzle0::Index], v[Swizzle1::Index], v[Swizzle2::Index]); }
-		template <class Swizzle0, class Swizzle1, class Swizzle2, class Swizzle3>
-		constexpr Vector<T, 4> _() { return Vector<T, 4>(v[Swizzle0::Index], v[Swizzle1::Index], v[Swizzle2::Index], v[Swizzle3::Index]); }
+		// Read swizzle, e.g. v._<_Z, _Y, _X>().
+		template <class... Swizzles>
+		constexpr Vector<T, sizeof...(Swizzles)> _() const noexcept { return Detail::Swizzle<T, Count, Swizzles::Index...>(v); }
+		// Write swizzle, e.g. v.Ref<_X, _Z>() = xz.
+		template <class... Swizzles>
+		constexpr SwizzleRef<T, Count, Swizzles::Index...> Ref() noexcept { return SwizzleRef<T, Count, Swizzles::Index...>(v); }
 
 		constexpr Vector const& operator+() const noexcept { return *this; }
 		constexpr Vector operator-() const noexcept { return Vector(-v[0], -v[1], -v[2], -v[3]); }
 
-		constexpr Vector& operator+=(Vector const& r) noexcept { v[0] += r.v[0]; v[1] += r.v[1]; v[2] += r.v[2]; v[3] += r.v[3]; return *this; }
-		constexpr Vector& operator-=(Vector const& r) noexcept { v[0] -= r.v[0]; v[1] -= r.v[1]; v[2] -= r.v[2]; v[3] -= r.v[3]; return *this; }
-		constexpr Vector& operator*=(Vector const& r) noexcept { v[0] *= r.v[0]; v[1] *= r.v[1]; v[2] *= r.v[2]; v[3] *= r.v[3]; return *this; }
-		constexpr Vector& operator*=(T const& r) noexcept { v[0] *= r; v[1] *= r; v[2] *= r; v[3] *= r; return *this; }
-		constexpr Vector& operator/=(Vector const& r) noexcept { v[0] /= r.v[0]; v[1] /= r.v[1]; v[2] /= r.v[2]; v[3] /= r.v[3]; return *this; }
-		constexpr Vector& operator/=(T const& r) noexcept { v[0] /= r; v[1] /= r; v[2] /= r; v[3] /= r; return *this; }
+		constexpr Vector& operator+=(Vector const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Add(v, v, r.v); return *this; } } v[0] += r.v[0]; v[1] += r.v[1]; v[2] += r.v[2]; v[3] += r.v[3]; return *this; }
+		constexpr Vector& operator-=(Vector const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Sub(v, v, r.v); return *this; } } v[0] -= r.v[0]; v[1] -= r.v[1]; v[2] -= r.v[2]; v[3] -= r.v[3]; return *this; }
+		constexpr Vector& operator*=(Vector const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Mul(v, v, r.v); return *this; } } v[0] *= r.v[0]; v[1] *= r.v[1]; v[2] *= r.v[2]; v[3] *= r.v[3]; return *this; }
+		constexpr Vector& operator*=(T const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Mul(v, v, r); return *this; } } v[0] *= r; v[1] *= r; v[2] *= r; v[3] *= r; return *this; }
+		constexpr Vector& operator/=(Vector const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Div(v, v, r.v); return *this; } } v[0] /= r.v[0]; v[1] /= r.v[1]; v[2] /= r.v[2]; v[3] /= r.v[3]; return *this; }
+		constexpr Vector& operator/=(T const& r) noexcept { if constexpr (Accelerated) { if (!IsConstantEvaluated()) { SIMD::VectorHelper<T, Count>::Div(v, v, r); return *this; } } v[0] /= r; v[1] /= r; v[2] /= r; v[3] /= r; return *this; }
 
-		constexpr Vector Normalized() const noexcept { static_assert(std::is_floating_point_v<T>, "Normalized() for floating point types only."); return *this / Length(); }
+		constexpr Vector Normalized() const noexcept { static_assert(std::is_floating_point_v<T>, "Normalized() for floating point types only."); if constexpr (Accelerated) { if (!IsConstantEvaluated()) { Vector result = *this; SIMD::VectorHelper<T, Count>::Normalize(result.v, v); return result; } } return *this / Length(); }
 
-		constexpr T Length() const noexcept { static_assert(std::is_floating_point_v<T>, "Length() for floating point types only."); return std::sqrt(LengthSquared()); }
+		constexpr T Length() const noexcept { static_assert(std::is_floating_point_v<T>, "Length() for floating point types only."); if constexpr (Accelerated) { if (!IsConstantEvaluated()) { return SIMD::VectorHelper<T, Count>::Length(v); } } return std::sqrt(LengthSquared()); }
 
 		constexpr T LengthSquared() const noexcept { return Dot(*this, *this); }
 
@@ -312,7 +491,7 @@ namespace X
 	template <class T>
 	constexpr bool operator!=(Vector<T, 4> const& l, Vector<T, 4> const& r) noexcept { return l.v[0] != r.v[0] || l.v[1] != r.v[1] || l.v[2] != r.v[2] || l.v[3] != r.v[3]; }
 	template <class T>
-	constexpr T Dot(Vector<T, 4> const& l, Vector<T, 4> const& r) noexcept { return l.v[0] * r.v[0] + l.v[1] * r.v[1] + l.v[2] * r.v[2] + l.v[3] * r.v[3]; }
+	constexpr T Dot(Vector<T, 4> const& l, Vector<T, 4> const& r) noexcept { if constexpr (Vector<T, 4>::Accelerated) { if (!IsConstantEvaluated()) { return SIMD::VectorHelper<T, 4>::Dot(l.v, r.v); } } return l.v[0] * r.v[0] + l.v[1] * r.v[1] + l.v[2] * r.v[2] + l.v[3] * r.v[3]; }
 
 
 	template <class T, uint32 Count>
@@ -0,0 +1,407 @@
+#pragma once
+#include "Core/BasicType.h"
+#include "Math/SIMD.h"
+#include "Math/Vector.h"
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace X
+{
+	/*
+	*	Non-owning view over an AoS array of Vector, nothing is copied until it is gathered into a VectorStream.
+	*/
+	template <class T, uint32 N>
+	class VectorArrayView
+	{
+	public:
+		constexpr VectorArrayView() noexcept = default;
+		constexpr VectorArrayView(Vector<T, N> const* data, uint32 size) noexcept : data(data), size(size) {}
+		template <uint32 Size>
+		constexpr VectorArrayView(Vector<T, N> const (&data)[Size]) noexcept : data(data), size(Size) {}
+
+		constexpr uint32 Size() const noexcept { return size; }
+		constexpr Vector<T, N> const* Data() const noexcept { return data; }
+
+		constexpr Vector<T, N> const& operator[](uint32 index) const noexcept { assert(index < size); return data[index]; }
+
+	private:
+		Vector<T, N> const* data = nullptr;
+		uint32 size = 0;
+	};
+
+	/*
+	*	Structure of arrays storage of Vector<T, N>, one lane array per component.
+	*	Every lane starts on a cache line and is padded to whole cache lines, so the batched kernels run full SIMD registers without tails.
+	*	Kernels resize their output, the padding of the output holds unspecified values.
+	*/
+	template <class T, uint32 N>
+	class VectorStream
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "VectorStream for trivially copyable types only.");
+
+	public:
+		static constexpr uint32 Dimension = N;
+		static constexpr uint32 Alignment = 64;
+		static constexpr uint32 Padding = Alignment / sizeof(T) > 0 ? Alignment / sizeof(T) : 1;
+
+		VectorStream() noexcept = default;
+
+		explicit VectorStream(uint32 size) { Resize(size); }
+
+		explicit VectorStream(VectorArrayView<T, N> aos) { Gather(aos); }
+
+		VectorStream(VectorStream const& other)
+		{
+			Resize(other.size);
+			for (uint32 c = 0; c < N && size > 0; ++c)
+			{
+				std::memcpy(Lane(c), other.Lane(c), sizeof(T) * size);
+			}
+		}
+
+		VectorStream(VectorStream&& other) noexcept : data(other.data), size(other.size), capacity(other.capacity)
+		{
+			other.data = nullptr;
+			other.size = 0;
+			other.capacity = 0;
+		}
+
+		VectorStream& operator=(VectorStream const& other)
+		{
+			if (this != &other)
+			{
+				Resize(other.size);
+				for (uint32 c = 0; c < N && size > 0; ++c)
+				{
+					std::memcpy(Lane(c), other.Lane(c), sizeof(T) * size);
+				}
+			}
+			return *this;
+		}
+
+		VectorStream& operator=(VectorStream&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Release();
+				data = other.data;
+				size = other.size;
+				capacity = other.capacity;
+				other.data = nullptr;
+				other.size = 0;
+				other.capacity = 0;
+			}
+			return *this;
+		}
+
+		~VectorStream() noexcept
+		{
+			Release();
+		}
+
+		uint32 Size() const noexcept { return size; }
+		// Size rounded up to Padding, kernels may process up to this many elements per lane.
+		uint32 PaddedSize() const noexcept { return (size + Padding - 1) / Padding * Padding; }
+		uint32 Capacity() const noexcept { return capacity; }
+		bool Empty() const noexcept { return size == 0; }
+
+		T* Lane(uint32 component) noexcept { assert(component < N); return data + component * capacity; }
+		T const* Lane(uint32 component) const noexcept { assert(component < N); return data + component * capacity; }
+
+		Vector<T, N> Get(uint32 index) const noexcept
+		{
+			assert(index < size);
+			Vector<T, N> result;
+			for (uint32 c = 0; c < N; ++c)
+			{
+				result.v[c] = Lane(c)[index];
+			}
+			return result;
+		}
+
+		void Set(uint32 index, Vector<T, N> const& value) noexcept
+		{
+			assert(index < size);
+			for (uint32 c = 0; c < N; ++c)
+			{
+				Lane(c)[index] = value.v[c];
+			}
+		}
+
+		void PushBack(Vector<T, N> const& value)
+		{
+			if (size == capacity)
+			{
+				Reserve(capacity == 0 ? Padding : capacity * 2);
+			}
+			size += 1;
+			Set(size - 1, value);
+		}
+
+		void Clear() noexcept
+		{
+			size = 0;
+		}
+
+		void Reserve(uint32 newCapacity)
+		{
+			newCapacity = (newCapacity + Padding - 1) / Padding * Padding;
+			if (newCapacity <= capacity)
+			{
+				return;
+			}
+
+			T* newData = static_cast<T*>(::operator new(sizeof(T) * N * newCapacity, std::align_val_t(Alignment)));
+			std::memset(newData, 0, sizeof(T) * N * newCapacity);
+			for (uint32 c = 0; c < N && size > 0; ++c)
+			{
+				std::memcpy(newData + c * newCapacity, Lane(c), sizeof(T) * size);
+			}
+			Release();
+			data = newData;
+			capacity = newCapacity;
+		}
+
+		void Resize(uint32 newSize)
+		{
+			Reserve(newSize);
+			size = newSize;
+		}
+
+		// Transposes the AoS source into the lanes.
+		void Gather(VectorArrayView<T, N> aos)
+		{
+			Resize(aos.Size());
+			Vector<T, N> const* source = aos.Data();
+			for (uint32 c = 0; c < N; ++c)
+			{
+				T* lane = Lane(c);
+				for (uint32 i = 0; i < size; ++i)
+				{
+					lane[i] = source[i].v[c];
+				}
+			}
+		}
+
+		// Writes Size() elements back to AoS storage.
+		void Scatter(Vector<T, N>* aos) const noexcept
+		{
+			for (uint32 c = 0; c < N; ++c)
+			{
+				T const* lane = Lane(c);
+				for (uint32 i = 0; i < size; ++i)
+				{
+					aos[i].v[c] = lane[i];
+				}
+			}
+		}
+
+	private:
+		void Release() noexcept
+		{
+			if (data)
+			{
+				::operator delete(data, std::align_val_t(Alignment));
+				data = nullptr;
+			}
+			capacity = 0;
+		}
+
+	private:
+		T* data = nullptr;
+		uint32 size = 0;
+		uint32 capacity = 0;
+	};
+
+	template <class T>
+	using ScalarStream = VectorStream<T, 1>;
+
+	// out = l + r
+	template <class T, uint32 N>
+	void Add(VectorStream<T, N>& out, VectorStream<T, N> const& l, VectorStream<T, N> const& r)
+	{
+		using P = SIMD::Pack<T>;
+		assert(l.Size() == r.Size());
+		out.Resize(l.Size());
+		uint32 const count = l.PaddedSize();
+		for (uint32 c = 0; c < N; ++c)
+		{
+			T const* a = l.Lane(c);
+			T const* b = r.Lane(c);
+			T* o = out.Lane(c);
+			for (uint32 i = 0; i < count; i += P::Width)
+			{
+				P::Store(o + i, P::Add(P::Load(a + i), P::Load(b + i)));
+			}
+		}
+	}
+
+	// out = l - r
+	template <class T, uint32 N>
+	void Sub(VectorStream<T, N>& out, VectorStream<T, N> const& l, VectorStream<T, N> const& r)
+	{
+		using P = SIMD::Pack<T>;
+		assert(l.Size() == r.Size());
+		out.Resize(l.Size());
+		uint32 const count = l.PaddedSize();
+		for (uint32 c = 0; c < N; ++c)
+		{
+			T const* a = l.Lane(c);
+			T const* b = r.Lane(c);
+			T* o = out.Lane(c);
+			for (uint32 i = 0; i < count; i += P::Width)
+			{
+				P::Store(o + i, P::Sub(P::Load(a + i), P::Load(b + i)));
+			}
+		}
+	}
+
+	// out = l * s
+	template <class T, uint32 N>
+	void Scale(VectorStream<T, N>& out, VectorStream<T, N> const& l, T const& s)
+	{
+		using P = SIMD::Pack<T>;
+		out.Resize(l.Size());
+		uint32 const count = l.PaddedSize();
+		auto const scale = P::Set(s);
+		for (uint32 c = 0; c < N; ++c)
+		{
+			T const* a = l.Lane(c);
+			T* o = out.Lane(c);
+			for (uint32 i = 0; i < count; i += P::Width)
+			{
+				P::Store(o + i, P::Mul(P::Load(a + i), scale));
+			}
+		}
+	}
+
+	// out = l * r + a, component wise.
+	template <class T, uint32 N>
+	void MulAdd(VectorStream<T, N>& out, VectorStream<T, N> const& l, VectorStream<T, N> const& r, VectorStream<T, N> const& a)
+	{
+		using P = SIMD::Pack<T>;
+		assert(l.Size() == r.Size() && l.Size() == a.Size());
+		out.Resize(l.Size());
+		uint32 const count = l.PaddedSize();
+		for (uint32 c = 0; c < N; ++c)
+		{
+			T const* x = l.Lane(c);
+			T const* y = r.Lane(c);
+			T const* z = a.Lane(c);
+			T* o = out.Lane(c);
+			for (uint32 i = 0; i < count; i += P::Width)
+			{
+				P::Store(o + i, P::MulAdd(P::Load(x + i), P::Load(y + i), P::Load(z + i)));
+			}
+		}
+	}
+
+	// out = l * s + a, e.g. position += velocity * dt.
+	template <class T, uint32 N>
+	void MulAdd(VectorStream<T, N>& out, VectorStream<T, N> const& l, T const& s, VectorStream<T, N> const& a)
+	{
+		using P = SIMD::Pack<T>;
+		assert(l.Size() == a.Size());
+		out.Resize(l.Size());
+		uint32 const count = l.PaddedSize();
+		auto const scale = P::Set(s);
+		for (uint32 c = 0; c < N; ++c)
+		{
+			T const* x = l.Lane(c);
+			T const* z = a.Lane(c);
+			T* o = out.Lane(c);
+			for (uint32 i = 0; i < count; i += P::Width)
+			{
+				P::Store(o + i, P::MulAdd(P::Load(x + i), scale, P::Load(z + i)));
+			}
+		}
+	}
+
+	template <class T, uint32 N>
+	void Dot(ScalarStream<T>& out, VectorStream<T, N> const& l, VectorStream<T, N> const& r)
+	{
+		using P = SIMD::Pack<T>;
+		assert(l.Size() == r.Size());
+		out.Resize(l.Size());
+		uint32 const count = l.PaddedSize();
+		T* o = out.Lane(0);
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto sum = P::Mul(P::Load(l.Lane(0) + i), P::Load(r.Lane(0) + i));
+			for (uint32 c = 1; c < N; ++c)
+			{
+				sum = P::MulAdd(P::Load(l.Lane(c) + i), P::Load(r.Lane(c) + i), sum);
+			}
+			P::Store(o + i, sum);
+		}
+	}
+
+	template <class T>
+	void Cross(VectorStream<T, 3>& out, VectorStream<T, 3> const& l, VectorStream<T, 3> const& r)
+	{
+		using P = SIMD::Pack<T>;
+		assert(l.Size() == r.Size());
+		out.Resize(l.Size());
+		uint32 const count = l.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto lx = P::Load(l.Lane(0) + i), ly = P::Load(l.Lane(1) + i), lz = P::Load(l.Lane(2) + i);
+			auto rx = P::Load(r.Lane(0) + i), ry = P::Load(r.Lane(1) + i), rz = P::Load(r.Lane(2) + i);
+			P::Store(out.Lane(0) + i, P::MulSub(ly, rz, P::Mul(lz, ry)));
+			P::Store(out.Lane(1) + i, P::MulSub(lz, rx, P::Mul(lx, rz)));
+			P::Store(out.Lane(2) + i, P::MulSub(lx, ry, P::Mul(ly, rx)));
+		}
+	}
+
+	template <class T, uint32 N>
+	void Length(ScalarStream<T>& out, VectorStream<T, N> const& v)
+	{
+		static_assert(std::is_floating_point_v<T>, "Length() for floating point types only.");
+		using P = SIMD::Pack<T>;
+		out.Resize(v.Size());
+		uint32 const count = v.PaddedSize();
+		T* o = out.Lane(0);
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto x = P::Load(v.Lane(0) + i);
+			auto sum = P::Mul(x, x);
+			for (uint32 c = 1; c < N; ++c)
+			{
+				x = P::Load(v.Lane(c) + i);
+				sum = P::MulAdd(x, x, sum);
+			}
+			P::Store(o + i, P::Sqrt(sum));
+		}
+	}
+
+	// Same semantics as Vector::Normalized(), v / Length().
+	template <class T, uint32 N>
+	void Normalized(VectorStream<T, N>& out, VectorStream<T, N> const& v)
+	{
+		static_assert(std::is_floating_point_v<T>, "Normalized() for floating point types only.");
+		using P = SIMD::Pack<T>;
+		out.Resize(v.Size());
+		uint32 const count = v.PaddedSize();
+		for (uint32 i = 0; i < count; i += P::Width)
+		{
+			auto x = P::Load(v.Lane(0) + i);
+			auto sum = P::Mul(x, x);
+			for (uint32 c = 1; c < N; ++c)
+			{
+				x = P::Load(v.Lane(c) + i);
+				sum = P::MulAdd(x, x, sum);
+			}
+			auto const length = P::Sqrt(sum);
+			for (uint32 c = 0; c < N; ++c)
+			{
+				P::Store(out.Lane(c) + i, P::Div(P::Load(v.Lane(c) + i), length));
+			}
+		}
+	}
+
+	using VS2F32 = VectorStream<float32, 2>;
+	using VS3F32 = VectorStream<float32, 3>;
+	using VS4F32 = VectorStream<float32, 4>;
+}
@@ -0,0 +1,158 @@
+#include "Test.h"
+#include "Math/DynamicMatrix.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace X;
+
+namespace
+{
+	template <class T>
+	DynamicMatrix<T> Random(uint32 rows, uint32 columns, std::mt19937& generator)
+	{
+		std::uniform_real_distribution<double> distribution(-1, 1);
+		DynamicMatrix<T> m(rows, columns);
+		for (uint32 c = 0; c < columns; ++c)
+		{
+			for (uint32 r = 0; r < rows; ++r)
+			{
+				m[Index2UI(r, c)] = T(distribution(generator));
+			}
+		}
+		return m;
+	}
+
+	// The plain loop, in the column-major friendly order so the compiler vectorizes the inner loop.
+	template <class T>
+	void NaiveMultiply(DynamicMatrix<T>& out, ConstMatrixView<T> l, ConstMatrixView<T> r)
+	{
+		out.Resize(l.Rows(), r.Columns());
+		for (uint32 j = 0; j < r.Columns(); ++j)
+		{
+			for (uint32 k = 0; k < l.Columns(); ++k)
+			{
+				T const x = r[Index2UI(k, j)];
+				for (uint32 i = 0; i < l.Rows(); ++i)
+				{
+					out[Index2UI(i, j)] += l[Index2UI(i, k)] * x;
+				}
+			}
+		}
+	}
+
+	template <class T>
+	double MaxDifference(DynamicMatrix<T> const& l, DynamicMatrix<T> const& r)
+	{
+		double difference = 0;
+		for (uint32 c = 0; c < l.Columns(); ++c)
+		{
+			for (uint32 i = 0; i < l.Rows(); ++i)
+			{
+				difference = std::fmax(difference, std::fabs(double(l[Index2UI(i, c)] - r[Index2UI(i, c)])));
+			}
+		}
+		return difference;
+	}
+
+	template <class T>
+	void CheckMultiply(uint32 m, uint32 k, uint32 n, std::mt19937& generator)
+	{
+		DynamicMatrix<T> const l = Random<T>(m, k, generator);
+		DynamicMatrix<T> const r = Random<T>(k, n, generator);
+		DynamicMatrix<T> product, parallel, expected;
+		Multiply(product, l, r);
+		Multiply(parallel, l, r, 3);
+		NaiveMultiply(expected, l.View(), r.View());
+		X_CHECK(product.Rows() == m && product.Columns() == n);
+		X_CHECK(MaxDifference(product, expected) < 1e-3);
+		X_CHECK(MaxDifference(parallel, expected) < 1e-3);
+
+		// the row-major path of the matrix vector product, through a transposed view.
+		std::vector<T> x(k, T(0.5)), y(m), xt(m, T(0.25)), yt(k);
+		Multiply(y.data(), l.View(), x.data());
+		Multiply(yt.data(), l.View().Transposed(), xt.data());
+		double difference = 0;
+		for (uint32 i = 0; i < m; ++i)
+		{
+			T sum = 0;
+			for (uint32 c = 0; c < k; ++c)
+			{
+				sum += l[Index2UI(i, c)] * x[c];
+			}
+			difference = std::fmax(difference, std::fabs(double(sum - y[i])));
+		}
+		for (uint32 c = 0; c < k; ++c)
+		{
+			T sum = 0;
+			for (uint32 i = 0; i < m; ++i)
+			{
+				sum += l[Index2UI(i, c)] * xt[i];
+			}
+			difference = std::fmax(difference, std::fabs(double(sum - yt[c])));
+		}
+		X_CHECK(difference < 1e-3);
+	}
+
+	// Views without elements, the matrix vector product zeroes out and reads nothing.
+	template <class T>
+	void CheckEmpty()
+	{
+		DynamicMatrix<T> const noRows(0, 5);
+		DynamicMatrix<T> const noColumns(4, 0);
+		T const x[5] = { 1, 2, 3, 4, 5 };
+		T y[5] = { 7, 7, 7, 7, 7 };
+		Multiply(y, noRows.View(), x);
+		X_CHECK(y[0] == 7);
+		Multiply(y, noColumns.View(), x);
+		X_CHECK(y[0] == 0 && y[3] == 0 && y[4] == 7);
+		Multiply(y, noColumns.View().Transposed(), x);
+		Multiply(y, noRows.View().Transposed(), x);
+		X_CHECK(y[0] == 0 && y[4] == 0);
+
+		DynamicMatrix<T> product;
+		Multiply(product, noColumns, noRows);
+		X_CHECK(product.Rows() == 4 && product.Columns() == 5 && product[Index2UI(3, 4)] == 0);
+	}
+}
+
+namespace PlayGround
+{
+	void TestDynamicMatrix()
+	{
+		std::mt19937 generator(1);
+		uint32 const sizes[][3] = { { 1, 1, 1 }, { 3, 5, 7 }, { 17, 33, 9 }, { 64, 64, 64 }, { 130, 300, 517 }, { 200, 1, 300 }, { 1, 200, 5 } };
+		for (auto const& size : sizes)
+		{
+			CheckMultiply<float32>(size[0], size[1], size[2], generator);
+			CheckMultiply<float64>(size[0], size[1], size[2], generator);
+		}
+		CheckEmpty<float32>();
+		CheckEmpty<float64>();
+	}
+
+	// Square products, the naive loop only up to 1024 where it still finishes in seconds.
+	void BenchmarkDynamicMatrix()
+	{
+		std::mt19937 generator(1);
+		std::printf("DynamicMatrix float32 multiply, GFLOP/s (blocked / naive)\n");
+		for (uint32 n = 64; n <= 4096; n *= 2)
+		{
+			DynamicMatrix<float32> const l = Random<float32>(n, n, generator);
+			DynamicMatrix<float32> const r = Random<float32>(n, n, generator);
+			DynamicMatrix<float32> out;
+			uint32 const repeat = n <= 256 ? 10 : n <= 1024 ? 3 : 1;
+			double const flop = 2.0 * n * n * n;
+			double const blocked = Measure(repeat, [&]() { Multiply(out, l, r); Consume(out[Index2UI(0, 0)]); });
+			if (n <= 1024)
+			{
+				double const naive = Measure(repeat, [&]() { out.Resize(0, 0); NaiveMultiply(out, l.View(), r.View()); Consume(out[Index2UI(0, 0)]); });
+				std::printf("  %4u  %7.2f / %7.2f\n", n, flop / blocked * 1e-9, flop / naive * 1e-9);
+			}
+			else
+			{
+				std::printf("  %4u  %7.2f /       -\n", n, flop / blocked * 1e-9);
+			}
+		}
+	}
+}
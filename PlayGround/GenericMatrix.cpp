@@ -0,0 +1,149 @@
+#include "Test.h"
+#include "Math/Vector.h"
+#include "Math/Matrix.h"
+#include <cmath>
+
+using namespace X;
+
+namespace
+{
+	// the generic templates stay usable in constant expressions.
+	constexpr Vector<float64, 6> a6(1, 2, 3, 4, 5, 6);
+	static_assert(Dot(a6, a6) == 91 && (a6 + a6)[5] == 12 && -a6 != a6, "");
+	static_assert((Matrix<float64, 6, 6>(2.0) * a6)[3] == 8 && Matrix<float64, 6, 6>(1.0) * Matrix<float64, 6, 6>(3.0) == Matrix<float64, 6, 6>(3.0), "");
+	static_assert(Matrix<float64, 6, 6>(2.0).Transposed() == Matrix<float64, 6, 6>(2.0), "");
+
+	// Small integers, so every product and sum is exact and results compare equal to the plain loops.
+	template <class T>
+	T Value(uint32 i, uint32 seed)
+	{
+		return T(sint32((i * 7 + seed * 3) % 11) - 5);
+	}
+
+	template <class T, uint32 N>
+	Vector<T, N> MakeVector(uint32 seed)
+	{
+		Vector<T, N> v;
+		for (uint32 i = 0; i < N; ++i)
+		{
+			v[i] = Value<T>(i, seed);
+		}
+		return v;
+	}
+
+	template <class T, uint32 R, uint32 C>
+	Matrix<T, R, C> MakeMatrix(uint32 seed)
+	{
+		Matrix<T, R, C> m;
+		for (uint32 c = 0; c < C; ++c)
+		{
+			for (uint32 r = 0; r < R; ++r)
+			{
+				m[Index2UI(r, c)] = Value<T>(c * R + r, seed);
+			}
+		}
+		return m;
+	}
+
+	template <class T, uint32 N>
+	void CheckVector()
+	{
+		Vector<T, N> const l = MakeVector<T, N>(1);
+		Vector<T, N> const r = MakeVector<T, N>(2);
+		Vector<T, N> const sum = l + r;
+		Vector<T, N> const difference = l - r;
+		Vector<T, N> const product = l * r;
+		Vector<T, N> const scaled = l * T(3);
+		Vector<T, N> const negated = -l;
+		T dot = 0;
+		bool same = true;
+		for (uint32 i = 0; i < N; ++i)
+		{
+			same = same && sum[i] == l[i] + r[i] && difference[i] == l[i] - r[i] && product[i] == l[i] * r[i] && scaled[i] == l[i] * T(3) && negated[i] == -l[i];
+			dot += l[i] * r[i];
+		}
+		X_CHECK(same);
+		X_CHECK(Dot(l, r) == dot);
+		X_CHECK(l.LengthSquared() == Dot(l, l));
+		X_CHECK(std::fabs(l.Normalized().Length() - T(1)) < T(1e-5));
+		X_CHECK(l == MakeVector<T, N>(1) && l != r);
+		X_CHECK(Vector<T, N>::Zero == Vector<T, N>(T(0)));
+	}
+
+	template <class T, uint32 R, uint32 K, uint32 C>
+	void CheckMultiply()
+	{
+		Matrix<T, R, K> const l = MakeMatrix<T, R, K>(1);
+		Matrix<T, K, C> const r = MakeMatrix<T, K, C>(2);
+		Vector<T, K> const v = MakeVector<T, K>(3);
+		Matrix<T, R, C> const product = l * r;
+		Vector<T, R> const transformed = l * v;
+		bool same = true;
+		for (uint32 i = 0; i < R; ++i)
+		{
+			for (uint32 j = 0; j < C; ++j)
+			{
+				T expected = 0;
+				for (uint32 k = 0; k < K; ++k)
+				{
+					expected += l[Index2UI(i, k)] * r[Index2UI(k, j)];
+				}
+				same = same && product[Index2UI(i, j)] == expected;
+			}
+			T expected = 0;
+			for (uint32 k = 0; k < K; ++k)
+			{
+				expected += l[Index2UI(i, k)] * v[k];
+			}
+			same = same && transformed[i] == expected;
+		}
+		X_CHECK(same);
+		X_CHECK(Matrix<T, R, R>::Identity * l == l);
+	}
+
+	template <class T, uint32 R, uint32 C>
+	void CheckTranspose()
+	{
+		Matrix<T, R, C> const m = MakeMatrix<T, R, C>(4);
+		Matrix<T, C, R> const transposed = m.Transposed();
+		bool same = true;
+		for (uint32 i = 0; i < R; ++i)
+		{
+			same = same && m.Row(i) == transposed.Column(i);
+			for (uint32 j = 0; j < C; ++j)
+			{
+				same = same && transposed[Index2UI(j, i)] == m[Index2UI(i, j)];
+			}
+		}
+		X_CHECK(same);
+		X_CHECK(transposed.Transposed() == m);
+
+		Matrix<T, C, R> const r = MakeMatrix<T, C, R>(5);
+		X_CHECK((m * r).Transposed() == r.Transposed() * transposed);
+	}
+}
+
+namespace PlayGround
+{
+	// Sizes without a specialization, against plain loops.
+	void TestGenericMatrix()
+	{
+		CheckVector<float32, 6>();
+		CheckVector<float32, 8>();
+		CheckVector<float32, 12>();
+		CheckVector<float64, 6>();
+		CheckVector<float64, 8>();
+		CheckVector<float64, 12>();
+
+		CheckMultiply<float32, 6, 6, 6>();
+		CheckMultiply<float32, 12, 12, 12>();
+		CheckMultiply<float64, 6, 6, 6>();
+		CheckMultiply<float64, 12, 12, 12>();
+		CheckMultiply<float64, 6, 12, 6>();
+		CheckMultiply<float64, 12, 6, 8>();
+
+		CheckTranspose<float32, 6, 6>();
+		CheckTranspose<float32, 12, 12>();
+		CheckTranspose<float64, 6, 12>();
+	}
+}
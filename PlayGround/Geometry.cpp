@@ -0,0 +1,80 @@
+#include "Test.h"
+#include "Math/Geometry.h"
+#include <cmath>
+
+using namespace X;
+
+namespace
+{
+	template <class T>
+	Vector<T, 3> Point(uint32 i, uint32 seed)
+	{
+		auto const value = [](uint32 n) { return T(sint32(n % 13) - 6) * T(0.5); };
+		return Vector<T, 3>(value(i * 5 + seed), value(i * 7 + seed * 3 + 1), value(i * 11 + seed * 5 + 2));
+	}
+
+	// Non zero components, so no slab test multiplies 0 by infinity.
+	template <class T>
+	Vector<T, 3> Direction(uint32 i)
+	{
+		return Vector<T, 3>(T(0.25) + T(i % 3), T(-0.75) + T(i % 2), T(0.5) - T(i % 5) * T(0.375));
+	}
+
+	// Every slot but the last holds a box, the packet results must match AABB::Intersects() box by box.
+	template <class T, uint32 W>
+	void CheckPacket()
+	{
+		AABBPacket<T, W> packet;
+		AABB<T, 3> boxes[W];
+		for (uint32 i = 0; i + 1 < W; ++i)
+		{
+			Vector<T, 3> const corner = Point<T>(i, 1);
+			boxes[i] = AABB<T, 3>(corner, corner + Vector<T, 3>(T(1) + T(i % 3), T(0.5), T(2)));
+			packet.Set(i, boxes[i]);
+		}
+		X_CHECK(packet.Get(0) == boxes[0]);
+
+		uint32 rayHits = 0;
+		uint32 segmentHits = 0;
+		for (uint32 k = 0; k < 64; ++k)
+		{
+			// every other one aimed at a box, the offset keeps the direction components non zero.
+			AABB<T, 3> const& target = boxes[k % (W - 1)];
+			Vector<T, 3> const aim = (target.minimum + target.maximum) * T(0.5) + Vector<T, 3>(T(0.125), T(0.0625), T(0.03125));
+			Vector<T, 3> const origin = Point<T>(k, 2) * T(3);
+			RayT<T> const ray(origin, k % 2 == 0 ? aim - origin : Direction<T>(k));
+			SegmentT<T> const segment(origin, k % 2 == 0 ? aim * T(2) - origin : origin + Direction<T>(k));
+			T rayNear[W];
+			T segmentNear[W];
+			uint32 const rayMask = packet.Intersects(ray, rayNear);
+			uint32 const segmentMask = packet.Intersects(segment, segmentNear);
+			X_CHECK((rayMask >> (W - 1)) == 0 && (segmentMask >> (W - 1)) == 0);
+			for (uint32 i = 0; i + 1 < W; ++i)
+			{
+				T tNear = 0;
+				bool const rayHit = boxes[i].Intersects(ray, tNear);
+				X_CHECK(rayHit == (((rayMask >> i) & 1) != 0));
+				X_CHECK(!rayHit || std::fabs(tNear - rayNear[i]) <= T(1e-4) * (T(1) + std::fabs(tNear)));
+				rayHits += rayHit ? 1 : 0;
+
+				bool const segmentHit = boxes[i].Intersects(segment, tNear);
+				X_CHECK(segmentHit == (((segmentMask >> i) & 1) != 0));
+				X_CHECK(!segmentHit || (std::fabs(tNear - segmentNear[i]) <= T(1e-4) && tNear >= T(0) && tNear <= T(1)));
+				segmentHits += segmentHit ? 1 : 0;
+			}
+		}
+		// both outcomes are covered.
+		X_CHECK(rayHits > 0 && rayHits < 64 * (W - 1));
+		X_CHECK(segmentHits > 0 && segmentHits < 64 * (W - 1));
+	}
+}
+
+namespace PlayGround
+{
+	void TestGeometry()
+	{
+		CheckPacket<float32, 4>();
+		CheckPacket<float32, 8>();
+		CheckPacket<float64, 4>();
+	}
+}
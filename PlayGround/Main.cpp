@@ -1,3 +1,4 @@
+#include "Test.h"
 #include "Core/CompressedPair.h"
 #define MemoryDebug
 #include "Core/ReferenceCount.h"
@@ -10,6 +11,7 @@
 #include <utility>
 #include <memory>
 #include <cassert>
+#include <cstring>
 
 using namespace X;
 
@@ -45,7 +47,7 @@ constexpr auto ConstantM()
 
 constexpr auto m = ConstantM();
 
-int main()
+int main(int argc, char** argv)
 {
 	auto f = ConstantV();
 
@@ -113,5 +115,23 @@ int main()
 	sflag = SF::A | SF::B | SF::C;
 	sflag = SF::A;
 
-	return 0;
+	PlayGround::TestVectorSIMD();
+	PlayGround::TestReferenceCount();
+	PlayGround::TestPooledReferenceCount();
+	PlayGround::TestGenericMatrix();
+	PlayGround::TestGeometry();
+	PlayGround::TestDynamicMatrix();
+
+	// benchmarks only on request, run them on a release build.
+	if (argc > 1 && std::strcmp(argv[1], "-benchmark") == 0)
+	{
+		PlayGround::BenchmarkVectorSIMD();
+		PlayGround::BenchmarkReferenceCount();
+		PlayGround::BenchmarkReferenceCounted();
+		PlayGround::BenchmarkPooledReferenceCount();
+		PlayGround::BenchmarkDynamicMatrix();
+	}
+
+	std::printf("%u check(s) failed\n", PlayGround::failureCount);
+	return PlayGround::failureCount == 0 ? 0 : 1;
 }
\ No newline at end of file
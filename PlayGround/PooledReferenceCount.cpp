@@ -0,0 +1,130 @@
+#include "Test.h"
+// same as Main.cpp, the reference count bases must look the same in every PlayGround file.
+#define MemoryDebug
+#include "Core/PooledReferenceCount.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace X;
+
+namespace
+{
+	// Small object, where the allocator dominates.
+	struct Node : ReferenceCountBase<true>
+	{
+		explicit Node(uint32 value) noexcept : value(value)
+		{
+		}
+
+		uint32 value;
+	};
+
+	// Creates and drops one object at a time, in nanoseconds per object.
+	template <class Create>
+	double Churn(uint32 count, Create create)
+	{
+		return PlayGround::Measure(10, [&]()
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				ReferenceCountPtr<Node> node = create(i);
+				PlayGround::Consume(node->value);
+			}
+		}) * 1e9 / count;
+	}
+
+	// Creates count objects, then drops them all.
+	template <class Create>
+	double Batch(std::vector<ReferenceCountPtr<Node>>& nodes, Create create)
+	{
+		uint32 const count = static_cast<uint32>(nodes.size());
+		return PlayGround::Measure(10, [&]()
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				nodes[i] = create(i);
+			}
+			for (ReferenceCountPtr<Node>& node : nodes)
+			{
+				node = nullptr;
+			}
+		}) * 1e9 / count;
+	}
+
+	// One thread creates, another drops, so every free is remote.
+	template <class Create>
+	double Handoff(std::vector<ReferenceCountPtr<Node>>& nodes, Create create)
+	{
+		uint32 const count = static_cast<uint32>(nodes.size());
+		return PlayGround::Measure(10, [&]()
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				nodes[i] = create(i);
+			}
+			std::thread([&nodes]()
+			{
+				for (ReferenceCountPtr<Node>& node : nodes)
+				{
+					node = nullptr;
+				}
+			}).join();
+		}) * 1e9 / count;
+	}
+}
+
+namespace PlayGround
+{
+	void TestPooledReferenceCount()
+	{
+		{
+			ReferenceCountPtr<Node> node = CreatePooledPtr<Node>(7);
+			X_CHECK(node->value == 7 && node->IsUniqueReference());
+			Node* first = node.Get();
+			node = nullptr;
+			// the block freed last on this thread is handed out next.
+			node = CreatePooledPtr<Node>(8);
+			X_CHECK(node.Get() == first && node->value == 8);
+
+			// freed by another thread, taken back once the local free list runs dry.
+			// node is still alive, so the local free list is empty and every block must come from the remote list.
+			std::vector<ReferenceCountPtr<Node>> nodes;
+			std::vector<Node*> freed;
+			for (uint32 i = 0; i < 1000; ++i)
+			{
+				nodes.push_back(CreatePooledPtr<Node>(i));
+				freed.push_back(nodes.back().Get());
+			}
+			std::thread([&nodes]() { nodes.clear(); }).join();
+			std::vector<Node*> reused;
+			for (uint32 i = 0; i < 1000; ++i)
+			{
+				nodes.push_back(CreatePooledPtr<Node>(i));
+				X_CHECK(nodes.back()->value == i);
+				reused.push_back(nodes.back().Get());
+			}
+			std::sort(freed.begin(), freed.end());
+			std::sort(reused.begin(), reused.end());
+			X_CHECK(reused == freed);
+		}
+		X_CHECK(ReferenceCountBase<true>::Count() == 0);
+	}
+
+	void BenchmarkPooledReferenceCount()
+	{
+		uint32 const count = 100000;
+		std::vector<ReferenceCountPtr<Node>> nodes(count);
+		auto pooled = [](uint32 i) { return CreatePooledPtr<Node>(i); };
+		auto global = [](uint32 i) { return CreatePtr<Node>(i); };
+
+		std::printf("Pooled reference count, %u objects of %u bytes, ns per object (CreatePooledPtr / CreatePtr)\n", count, uint32(sizeof(Node)));
+		auto report = [](char const* name, double pooled, double global)
+		{
+			std::printf("  %-16s %6.2f / %6.2f\n", name, pooled, global);
+		};
+		report("one at a time", Churn(count, pooled), Churn(count, global));
+		report("all then free", Batch(nodes, pooled), Batch(nodes, global));
+		report("remote free", Handoff(nodes, pooled), Handoff(nodes, global));
+	}
+}
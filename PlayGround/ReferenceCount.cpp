@@ -0,0 +1,279 @@
+#include "Test.h"
+// same as Main.cpp, the reference count bases must look the same in every PlayGround file.
+#define MemoryDebug
+#include "Core/ReferenceCount.h"
+#include "Core/WeakReferenceCount.h"
+#include "Core/RefCountedArray.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace X;
+
+namespace
+{
+	constexpr uint32 ThreadCount = 4;
+
+	// Counted from the releasing threads, checked on the main thread after joining.
+	std::atomic<uint32> releaseCount = 0;
+	std::atomic<uint32> unorderedCount = 0;
+
+	// Each thread writes its slot before dropping its reference, the release must see every write.
+	struct Slots
+	{
+		uint32 slots[ThreadCount] = {};
+
+		void Write(uint32 thread) noexcept
+		{
+			slots[thread] = thread + 1;
+		}
+
+		void Verify() const noexcept
+		{
+			for (uint32 i = 0; i < ThreadCount; ++i)
+			{
+				if (slots[i] != i + 1)
+				{
+					unorderedCount.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			releaseCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	struct Shared final : ReferenceCountBase<true>, Slots
+	{
+	protected:
+		void OnRelease() noexcept override
+		{
+			Verify();
+			delete this;
+		}
+	};
+
+	struct WeakShared final : WeakReferenceCountBase, Slots
+	{
+	protected:
+		void OnRelease() noexcept override
+		{
+			Verify();
+			delete this;
+		}
+	};
+
+	struct Counted final : ReferenceCounted<Counted>, Slots
+	{
+		void OnRelease() noexcept
+		{
+			Verify();
+			delete this;
+		}
+	};
+
+	struct Element
+	{
+		uint32 value = 0;
+
+		~Element()
+		{
+			if (value == 0)
+			{
+				unorderedCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			releaseCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	struct VirtualNode : ReferenceCountBase<true>
+	{
+		uint32 value = 1;
+	};
+
+	struct CountedNode final : ReferenceCounted<CountedNode>
+	{
+		uint32 value = 1;
+	};
+
+	struct SingleThreadVirtualNode : ReferenceCountBase<false>
+	{
+		uint32 value = 1;
+	};
+
+	struct SingleThreadCountedNode final : ReferenceCounted<SingleThreadCountedNode, ReferenceCountPolicy::SingleThread>
+	{
+		uint32 value = 1;
+	};
+
+	// Hands one reference to each thread, which writes through it and then drops it together with the others.
+	template <class Pointer, class Write>
+	void ReleaseConcurrently(Pointer pointer, Write write)
+	{
+		std::vector<Pointer> copies(ThreadCount, pointer);
+		pointer = nullptr;
+		std::atomic<bool> start = false;
+		std::vector<std::thread> threads;
+		for (uint32 t = 0; t < ThreadCount; ++t)
+		{
+			threads.emplace_back([&start, &write, t, copy = std::move(copies[t])]() mutable
+			{
+				write(copy, t);
+				while (!start.load(std::memory_order_acquire))
+				{
+					std::this_thread::yield();
+				}
+				copy = nullptr;
+			});
+		}
+		start.store(true, std::memory_order_release);
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	// Copies and drops a reference to one shared object from every thread, in million pairs per second.
+	template <class Pointer>
+	double Contention(Pointer const& shared, uint32 threadCount, uint32 count)
+	{
+		double const seconds = PlayGround::Measure(5, [&]()
+		{
+			std::vector<std::thread> threads;
+			for (uint32 t = 0; t < threadCount; ++t)
+			{
+				threads.emplace_back([&shared, count]()
+				{
+					for (uint32 i = 0; i < count; ++i)
+					{
+						Pointer copy(shared);
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+		});
+		return double(threadCount) * count / seconds * 1e-6;
+	}
+}
+
+namespace PlayGround
+{
+	// OnRelease runs exactly once and after every write of the other threads, run it under a thread sanitizer too.
+	void TestReferenceCount()
+	{
+		uint32 const rounds = 500;
+		auto write = [](auto& pointer, uint32 thread) { pointer->Write(thread); };
+
+		releaseCount = 0;
+		unorderedCount = 0;
+		for (uint32 i = 0; i < rounds; ++i)
+		{
+			ReleaseConcurrently(CreatePtr<Shared>(), write);
+		}
+		X_CHECK(releaseCount == rounds);
+		X_CHECK(unorderedCount == 0);
+		X_CHECK(ReferenceCountBase<true>::Count() == 0);
+
+		releaseCount = 0;
+		for (uint32 i = 0; i < rounds; ++i)
+		{
+			ReleaseConcurrently(CreatePtr<Counted>(), write);
+		}
+		X_CHECK(releaseCount == rounds);
+		X_CHECK(unorderedCount == 0);
+		X_CHECK(Counted::Count() == 0);
+
+		// every other round through the control of a weak reference.
+		releaseCount = 0;
+		for (uint32 i = 0; i < rounds; ++i)
+		{
+			ReferenceCountPtr<WeakShared> pointer = CreatePtr<WeakShared>();
+			WeakReferenceCountPtr<WeakShared> weak;
+			if (i % 2 == 0)
+			{
+				weak = pointer;
+			}
+			ReleaseConcurrently(std::move(pointer), write);
+			X_CHECK(!weak.Lock());
+		}
+		X_CHECK(releaseCount == rounds);
+		X_CHECK(unorderedCount == 0);
+		X_CHECK(WeakReferenceCountBase::Count() == 0);
+
+		releaseCount = 0;
+		for (uint32 i = 0; i < rounds; ++i)
+		{
+			ReleaseConcurrently(SharedArray<Element>(RefCountedArray<Element>::Create(ThreadCount)), [](auto& array, uint32 thread)
+			{
+				(*array)[thread].value = thread + 1;
+			});
+		}
+		X_CHECK(releaseCount == rounds * ThreadCount);
+		X_CHECK(unorderedCount == 0);
+	}
+
+	void BenchmarkReferenceCount()
+	{
+		uint32 const count = 1000000;
+		ReferenceCountPtr<Shared> shared = CreatePtr<Shared>();
+		ReferenceCountPtr<Counted> counted = CreatePtr<Counted>();
+		ReferenceCountPtr<WeakShared> weakShared = CreatePtr<WeakShared>();
+		WeakReferenceCountPtr<WeakShared> weak(weakShared);
+
+		std::printf("Reference count contention, %u hardware threads, million copy and release pairs per second (1 / %u threads)\n", std::thread::hardware_concurrency(), ThreadCount);
+		auto report = [count](char const* name, auto const& pointer)
+		{
+			std::printf("  %-24s %8.1f / %8.1f\n", name, Contention(pointer, 1, count), Contention(pointer, ThreadCount, count / ThreadCount));
+		};
+		report("ReferenceCountBase<true>", shared);
+		report("ReferenceCounted", counted);
+		report("WeakReferenceCountBase", weakShared);
+	}
+
+	// ReferenceCounted against the virtual bases it replaces, the release inlines and the object has no virtual table pointer.
+	void BenchmarkReferenceCounted()
+	{
+		uint32 const count = 100000;
+		uint32 const repeat = 20;
+
+		// create and release, the last release calls OnRelease and the destructor.
+		auto churn = [count, repeat](auto create)
+		{
+			return Measure(repeat, [&]()
+			{
+				for (uint32 i = 0; i < count; ++i)
+				{
+					auto node = create();
+					Consume(node->value);
+				}
+			}) * 1e9 / count;
+		};
+		// copy and release references to many live objects, sums a member through each.
+		auto traverse = [count, repeat](auto create)
+		{
+			std::vector<decltype(create())> nodes;
+			for (uint32 i = 0; i < count; ++i)
+			{
+				nodes.push_back(create());
+			}
+			return Measure(repeat, [&]()
+			{
+				uint32 sum = 0;
+				for (auto const& node : nodes)
+				{
+					auto copy = node;
+					sum += copy->value;
+				}
+				Consume(sum);
+			}) * 1e9 / count;
+		};
+
+		std::printf("ReferenceCounted against the virtual base, ns per object (ReferenceCounted / ReferenceCountBase)\n");
+		std::printf("  object size, bytes     %6u / %6u\n", uint32(sizeof(CountedNode)), uint32(sizeof(VirtualNode)));
+		std::printf("  thread safe churn      %6.2f / %6.2f\n", churn([]() { return CreatePtr<CountedNode>(); }), churn([]() { return CreatePtr<VirtualNode>(); }));
+		std::printf("  thread safe traverse   %6.2f / %6.2f\n", traverse([]() { return CreatePtr<CountedNode>(); }), traverse([]() { return CreatePtr<VirtualNode>(); }));
+		std::printf("  single thread churn    %6.2f / %6.2f\n", churn([]() { return CreatePtr<SingleThreadCountedNode>(); }), churn([]() { return CreatePtr<SingleThreadVirtualNode>(); }));
+		std::printf("  single thread traverse %6.2f / %6.2f\n", traverse([]() { return CreatePtr<SingleThreadCountedNode>(); }), traverse([]() { return CreatePtr<SingleThreadVirtualNode>(); }));
+	}
+}
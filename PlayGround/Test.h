@@ -0,0 +1,65 @@
+#pragma once
+#include "Core/BasicType.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+/*
+*	Checks and timing shared by the PlayGround suites.
+*	Checks stay on in release builds, where the benchmarks are meaningful, and only count and report failures.
+*/
+#define X_CHECK(...) PlayGround::Check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+namespace PlayGround
+{
+	inline X::uint32 failureCount = 0;
+
+	inline void Check(bool condition, char const* expression, char const* file, int line)
+	{
+		if (!condition)
+		{
+			++failureCount;
+			std::printf("%s(%d): check failed: %s\n", file, line, expression);
+		}
+	}
+
+	// Fastest of repeat runs of f, in seconds.
+	template <class F>
+	double Measure(X::uint32 repeat, F&& f)
+	{
+		double best = 0;
+		for (X::uint32 i = 0; i < repeat; ++i)
+		{
+			auto const begin = std::chrono::steady_clock::now();
+			f();
+			double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			best = i == 0 || seconds < best ? seconds : best;
+		}
+		return best;
+	}
+
+	// Makes value observable, so the work producing it is not optimized away.
+	template <class T>
+	void Consume(T const& value)
+	{
+		static unsigned char volatile sink;
+		unsigned char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		for (unsigned char byte : bytes)
+		{
+			sink = sink ^ byte;
+		}
+	}
+
+	void TestVectorSIMD();
+	void BenchmarkVectorSIMD();
+	void TestReferenceCount();
+	void BenchmarkReferenceCount();
+	void BenchmarkReferenceCounted();
+	void TestPooledReferenceCount();
+	void BenchmarkPooledReferenceCount();
+	void TestGenericMatrix();
+	void TestGeometry();
+	void TestDynamicMatrix();
+	void BenchmarkDynamicMatrix();
+}
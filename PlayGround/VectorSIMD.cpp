@@ -0,0 +1,241 @@
+#include "Test.h"
+#include "Math/SIMD.h"
+#include "Math/Vector.h"
+#include "Math/Matrix.h"
+#include <cmath>
+#include <vector>
+
+using namespace X;
+
+namespace
+{
+	constexpr V4F32 a4(1, -2, 3, 0.5f);
+	constexpr V4F32 b4(-4, 5, 0.25f, 8);
+	constexpr V3F32 a3(1, -2, 3);
+	constexpr V3F32 b3(-4, 5, 0.25f);
+	constexpr M44F32 m44(
+		2, 0, 1, 0,
+		1, 3, 0, 0,
+		0, 1, 4, 0,
+		5, -1, 2, 1);
+
+	bool Near(float32 l, float32 r)
+	{
+		return std::fabs(l - r) <= 1e-5f * (1 + std::fabs(l) + std::fabs(r));
+	}
+
+	template <uint32 N>
+	bool Near(Vector<float32, N> const& l, Vector<float32, N> const& r)
+	{
+		for (uint32 i = 0; i < N; ++i)
+		{
+			if (!Near(l[i], r[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Near(M44F32 const& l, M44F32 const& r)
+	{
+		for (uint32 i = 0; i < 4; ++i)
+		{
+			if (!Near(l[i], r[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Keeps the operands opaque, so the runtime path is really taken at runtime.
+	template <class T>
+	T Opaque(T const& value)
+	{
+		static T storage[1];
+		static uint32 volatile index = 0;
+		storage[0] = value;
+		return storage[index];
+	}
+
+	// Same expressions as the constexpr path of the Vector and Matrix templates, on plain arrays.
+	float32 ScalarDot(float32 const l[4], float32 const r[4])
+	{
+		return l[0] * r[0] + l[1] * r[1] + l[2] * r[2] + l[3] * r[3];
+	}
+
+	void ScalarNormalize(float32 out[4], float32 const v[4])
+	{
+		float32 const length = std::sqrt(ScalarDot(v, v));
+		for (uint32 i = 0; i < 4; ++i)
+		{
+			out[i] = v[i] / length;
+		}
+	}
+
+	void ScalarAdd(float32 out[4], float32 const l[4], float32 const r[4])
+	{
+		for (uint32 i = 0; i < 4; ++i)
+		{
+			out[i] = l[i] + r[i];
+		}
+	}
+
+	void ScalarMultiply(float32 out[16], float32 const l[16], float32 const r[16])
+	{
+		for (uint32 c = 0; c < 4; ++c)
+		{
+			for (uint32 i = 0; i < 4; ++i)
+			{
+				out[c * 4 + i] = l[i] * r[c * 4] + l[4 + i] * r[c * 4 + 1] + l[8 + i] * r[c * 4 + 2] + l[12 + i] * r[c * 4 + 3];
+			}
+		}
+	}
+
+	// Loops of count vectors and matrixCount matrices, fastest of repeat runs.
+	void Benchmark(uint32 count, uint32 matrixCount, uint32 repeat)
+	{
+		std::vector<V4F32> l(count), r(count), out(count);
+		std::vector<M44F32> ml(matrixCount), mr(matrixCount), mout(matrixCount);
+		for (uint32 i = 0; i < count; ++i)
+		{
+			float32 const f = float32(i % 97) * 0.01f + 1;
+			l[i] = V4F32(f, -f, 2 * f, 0.5f);
+			r[i] = V4F32(0.5f, f, -f, 3 * f);
+		}
+		for (uint32 i = 0; i < matrixCount; ++i)
+		{
+			ml[i] = M44F32(float32(i % 97) * 0.01f + 1);
+			mr[i] = m44;
+		}
+
+		std::printf("  %u vectors, %u matrices\n", count, matrixCount);
+		auto report = [](char const* name, uint32 count, double simd, double scalar)
+		{
+			std::printf("    %-16s %6.2f / %6.2f\n", name, simd * 1e9 / count, scalar * 1e9 / count);
+		};
+
+		double const dot = PlayGround::Measure(repeat, [&]()
+		{
+			float32 sum = 0;
+			for (uint32 i = 0; i < count; ++i)
+			{
+				sum += Dot(l[i], r[i]);
+			}
+			PlayGround::Consume(sum);
+		});
+		double const scalarDot = PlayGround::Measure(repeat, [&]()
+		{
+			float32 sum = 0;
+			for (uint32 i = 0; i < count; ++i)
+			{
+				sum += ScalarDot(l[i].v, r[i].v);
+			}
+			PlayGround::Consume(sum);
+		});
+		report("Dot", count, dot, scalarDot);
+
+		double const normalize = PlayGround::Measure(repeat, [&]()
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				out[i] = l[i].Normalized();
+			}
+			PlayGround::Consume(out[count - 1]);
+		});
+		double const scalarNormalize = PlayGround::Measure(repeat, [&]()
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				ScalarNormalize(out[i].v, l[i].v);
+			}
+			PlayGround::Consume(out[count - 1]);
+		});
+		report("Normalized", count, normalize, scalarNormalize);
+
+		double const add = PlayGround::Measure(repeat, [&]()
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				out[i] = l[i] + r[i];
+			}
+			PlayGround::Consume(out[count - 1]);
+		});
+		double const scalarAdd = PlayGround::Measure(repeat, [&]()
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				ScalarAdd(out[i].v, l[i].v, r[i].v);
+			}
+			PlayGround::Consume(out[count - 1]);
+		});
+		report("Add", count, add, scalarAdd);
+
+		double const multiply = PlayGround::Measure(repeat, [&]()
+		{
+			for (uint32 i = 0; i < matrixCount; ++i)
+			{
+				mout[i] = ml[i] * mr[i];
+			}
+			PlayGround::Consume(mout[matrixCount - 1]);
+		});
+		double const scalarMultiply = PlayGround::Measure(repeat, [&]()
+		{
+			for (uint32 i = 0; i < matrixCount; ++i)
+			{
+				ScalarMultiply(mout[i].v[0].v, ml[i].Data(), mr[i].Data());
+			}
+			PlayGround::Consume(mout[matrixCount - 1]);
+		});
+		report("M44F32 multiply", matrixCount, multiply, scalarMultiply);
+	}
+}
+
+namespace PlayGround
+{
+	// The runtime SIMD path must give the constexpr scalar results.
+	void TestVectorSIMD()
+	{
+		constexpr V4F32 sum4 = a4 + b4;
+		constexpr V4F32 product4 = a4 * b4;
+		constexpr V4F32 quotient4 = a4 / b4;
+		constexpr float32 dot4 = Dot(a4, b4);
+		constexpr float32 length4 = a4.LengthSquared();
+		X_CHECK(Near(Opaque(a4) + Opaque(b4), sum4));
+		X_CHECK(Near(Opaque(a4) * Opaque(b4), product4));
+		X_CHECK(Near(Opaque(a4) / Opaque(b4), quotient4));
+		X_CHECK(Near(Dot(Opaque(a4), Opaque(b4)), dot4));
+		X_CHECK(Near(Opaque(a4).Length(), std::sqrt(length4)));
+		X_CHECK(Near(Opaque(a4).Normalized().Length(), 1));
+
+		constexpr V3F32 sum3 = a3 - b3;
+		constexpr V3F32 cross3 = Cross(a3, b3);
+		constexpr V3F32 quotient3 = a3 / b3;
+		X_CHECK(Near(Opaque(a3) - Opaque(b3), sum3));
+		X_CHECK(Near(Cross(Opaque(a3), Opaque(b3)), cross3));
+		X_CHECK(Near(Opaque(a3) / Opaque(b3), quotient3));
+		X_CHECK(Near(Dot(Opaque(a3), Opaque(b3)), Dot(a3, b3)));
+
+		constexpr M44F32 square = m44 * m44;
+		constexpr M44F32 transposed = m44.Transposed();
+		X_CHECK(Near(Opaque(m44) * Opaque(m44), square));
+		X_CHECK(Near(Opaque(m44).Transposed(), transposed));
+		X_CHECK(Near(Opaque(m44).Inversed() * m44, M44F32(1)));
+	}
+
+	void BenchmarkVectorSIMD()
+	{
+#if defined(X_SIMD_AVX2)
+		char const* backend = "AVX2";
+#elif defined(X_SIMD_SSE41)
+		char const* backend = "SSE4.1";
+#else
+		char const* backend = "none";
+#endif
+		std::printf("Vector SIMD, backend %s, ns per element (SIMD / scalar)\n", backend);
+		// in L1, then far out of cache like a per frame loop over every transform.
+		Benchmark(4096, 4096, 200);
+		Benchmark(4 * 1024 * 1024, 1024 * 1024, 5);
+	}
+}